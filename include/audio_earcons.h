@@ -0,0 +1,69 @@
+#ifndef AUDIO_EARCONS_H
+#define AUDIO_EARCONS_H
+
+#include "audio_synth.h"
+#include "ima_adpcm.h"
+
+// UI feedback sounds
+enum Earcon : uint8_t
+{
+    EARCON_STARTUP,        // Audio system up
+    EARCON_READY,          // Boot complete
+    EARCON_SCREEN_ENTER,   // Switched to a sub screen
+    EARCON_SCREEN_EXIT,    // Back to the main screen
+    EARCON_PLAY_PAUSE,
+    EARCON_NEXT,
+    EARCON_PREVIOUS,
+    EARCON_NAV_UP,
+    EARCON_NAV_DOWN,
+    EARCON_SELECT,
+    EARCON_CONFIRM,        // Action succeeded
+    EARCON_ALREADY_ACTIVE, // Nothing to do
+    EARCON_REJECT,         // Invalid input
+    EARCON_ERROR,          // Action failed
+    EARCON_COUNT
+};
+
+struct EarconDefinition
+{
+    const char *name;
+    const SynthNote *notes;
+    uint8_t noteCount;
+};
+
+// Pre-rendered earcon: IMA-ADPCM in flash, generated at build time by
+// scripts/render_earcons.py from the note tables in audio_earcons.cpp
+struct EarconClip
+{
+    const uint8_t *adpcm;
+    uint32_t sampleCount;
+};
+
+const EarconDefinition &audio_earcon(Earcon earcon);
+bool audio_earcon_bank_available();
+
+// Streams one pre-rendered earcon straight out of memory-mapped flash: no heap,
+// no intermediate buffer, decode and volume scaling in the output copy loop
+class EarconStream
+{
+public:
+    EarconStream();
+    bool start(Earcon earcon);
+    void stop();
+    bool isActive() const { return remaining > 0; }
+
+    // Write the next frames as 32-bit I2S slots scaled by gain (Q15), padding with silence
+    void renderSlots(int32_t *slots, int frames, int32_t gain);
+    // Add the next frames (unscaled Q15) into a mix accumulator
+    void mix(int32_t *accumulator, int frames);
+
+private:
+    const uint8_t *data;
+    uint32_t position; // Next sample index
+    uint32_t remaining;
+    ImaAdpcmState state;
+
+    inline int16_t next();
+};
+
+#endif // AUDIO_EARCONS_H
@@ -0,0 +1,37 @@
+#ifndef AUDIO_FFT_H
+#define AUDIO_FFT_H
+
+#include <stdint.h>
+
+// Real FFT size (Q15 fixed point, radix-2/4 over an N/2-point complex FFT).
+// No Arduino dependencies: also built for the native test env.
+#define AUDIO_FFT_SIZE 256
+#define AUDIO_FFT_BINS (AUDIO_FFT_SIZE / 2 + 1)
+#define AUDIO_FFT_MAX_BANDS 16
+
+// Log-spaced band display range (dB relative to the FFT output, full scale ~78 dB)
+#define AUDIO_FFT_BAND_FLOOR_DB 18.0f
+#define AUDIO_FFT_BAND_RANGE_DB 60.0f
+
+// Setup: precomputes Hann window, twiddles and octave band edges
+bool audio_fft_init(uint32_t sampleRate, int numBands);
+bool audio_fft_uses_simd(); // esp-dsp complex stage instead of the scalar one
+
+// Windowed real FFT of AUDIO_FFT_SIZE samples. spectrum receives AUDIO_FFT_BINS
+// complex values (re, im interleaved), scaled by 1/(N/2)
+void audio_fft_real(const int16_t *samples, int32_t *spectrum);
+
+// Power per bin (AUDIO_FFT_BINS entries)
+void audio_fft_power(const int16_t *samples, uint32_t *power);
+
+// Aggregate a power spectrum into octave bands centered on 1 kHz * 2^(b-4), normalized 0-1
+void audio_fft_bands(const uint32_t *power, float *bands, int numBands);
+
+#ifdef AUDIO_FFT_SELF_TEST
+// On-device accuracy (vs double precision DFT) and timing of the scalar / SIMD
+// paths; drops SIMD if it disagrees. Debug builds only, it costs boot time.
+// The scalar path is covered on the host by test/test_audio_fft.
+void audio_fft_self_test();
+#endif
+
+#endif // AUDIO_FFT_H
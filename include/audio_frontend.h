@@ -0,0 +1,56 @@
+#ifndef AUDIO_FRONTEND_H
+#define AUDIO_FRONTEND_H
+
+#include <stdint.h>
+
+// INMP441 -> Q15: the 24-bit sample sits in the top of a 32-bit slot.
+// Shifting by 11 keeps the historical +30 dB gain over a plain >>16, with saturation instead of wraparound.
+#define FRONTEND_INPUT_SHIFT 11
+
+// DC blocker y[n] = x[n] - x[n-1] + R * y[n-1] with R = 1 - 2^-8 (~0.996, corner ~10 Hz
+// at 16 kHz), so the feedback is a shift and subtract instead of a multiply
+#define FRONTEND_DC_SHIFT 8
+
+// AGC: boost quiet speech towards the target, never boost the noise floor
+#define FRONTEND_AGC_TARGET_RMS 3000 // ~-21 dBFS
+#define FRONTEND_AGC_MIN_RMS 64      // Below this the gain is frozen
+#define FRONTEND_AGC_MAX_GAIN_Q8 (16 << 8)
+
+struct AudioFrontEnd
+{
+    int32_t dcPrevInput;
+    int32_t dcState; // y[n-1] with FRONTEND_DC_SHIFT extra fractional bits
+    bool agcEnabled;
+    int32_t agcGainQ8;
+};
+
+void audio_frontend_init(AudioFrontEnd &fe);
+
+// Individual stages
+void audio_frontend_convert(const int32_t *raw, int16_t *out, int count);
+void audio_frontend_dc_block(AudioFrontEnd &fe, int16_t *samples, int count);
+void audio_frontend_measure(const int16_t *samples, int count, uint16_t *rms, uint16_t *peak);
+
+// Full chain: convert, DC removal, optional AGC; returns block RMS/peak of the output
+void audio_frontend_process(AudioFrontEnd &fe, const int32_t *raw, int16_t *out, int count,
+                            uint16_t *rms, uint16_t *peak);
+
+// Per-block timing of the Q15 chain against the previous float conversion/RMS loop
+#define FRONTEND_BENCHMARK_SAMPLES 256
+
+struct AudioFrontEndTimings
+{
+    float floatUs;   // Float convert + RMS (the old path)
+    float convertUs; // Q15 convert + RMS/peak
+    float chainUs;   // + DC block
+    float agcUs;     // + AGC
+    float floatLevel;
+    uint16_t rms;
+    uint16_t peak;
+};
+
+// Runs on device (-DAUDIO_FRONTEND_BENCHMARK) and in test/test_audio_frontend;
+// clockUs is the platform's microsecond clock
+void audio_frontend_benchmark(int64_t (*clockUs)(), AudioFrontEndTimings &timings);
+
+#endif // AUDIO_FRONTEND_H
@@ -3,11 +3,19 @@
 
 #include <Arduino.h>
 #include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "audio_fft.h"
+#include "audio_frontend.h"
+#include "audio_vad.h"
+#include "audio_ring_buffer.h"
+#include "audio_synth.h"
+#include "audio_earcons.h"
 
 // Audio visualization constants
 #define NUM_BANDS 8 // Number of frequency bands for visualization
-#define FFT_SIZE 256
-#define BUFFER_SIZE 1024
+#define FFT_SIZE AUDIO_FFT_SIZE
 
 // I2S Configuration - Shared bus for INMP441 and MAX98357A
 #define I2S_WS_PIN 15  // GPIO15 -> LRCLK (Word Select) - shared
@@ -17,15 +25,53 @@
 #define I2S_SD_IN_PIN 13  // GPIO13 -> INMP441 microphone data input
 #define I2S_SD_OUT_PIN 21 // GPIO21 -> MAX98357A amplifier data output
 
+// Full-duplex bus settings. Speaker and microphone share BCLK/WS, so both run
+// at the microphone's rate and slot width; the port is configured once.
+#define AUDIO_SAMPLE_RATE 16000  // Better for voice, reduces noise
+#define AUDIO_BITS_PER_SAMPLE 32 // INMP441 needs 32-bit slots, MAX98357A takes the top 16 bits
+#define AUDIO_CHANNELS 1         // Mono
+
 // Audio settings for output (speaker)
-#define OUTPUT_SAMPLE_RATE 44100 // CD quality for output
-#define OUTPUT_BITS_PER_SAMPLE 16
-#define OUTPUT_CHANNELS 1 // Mono
+#define OUTPUT_SAMPLE_RATE AUDIO_SAMPLE_RATE
+#define OUTPUT_BITS_PER_SAMPLE 16 // Generated sample precision, shifted into 32-bit slots
+#define OUTPUT_CHANNELS AUDIO_CHANNELS
 
 // Audio settings for input (microphone) - optimized for voice
-#define INPUT_SAMPLE_RATE 16000  // Better for voice, reduces noise
-#define INPUT_BITS_PER_SAMPLE 32 // Better signal-to-noise ratio
-#define INPUT_CHANNELS 1         // Mono
+#define INPUT_SAMPLE_RATE AUDIO_SAMPLE_RATE
+#define INPUT_BITS_PER_SAMPLE AUDIO_BITS_PER_SAMPLE // Better signal-to-noise ratio
+#define INPUT_CHANNELS AUDIO_CHANNELS
+
+// Capture task (drains I2S RX DMA into the capture ring)
+#define CAPTURE_TASK_STACK 4096
+#define CAPTURE_TASK_PRIORITY 5 // Above WiFi/HTTP work on core 0, DMA must not overflow
+#define CAPTURE_TASK_CORE 0
+#define CAPTURE_READ_TIMEOUT_MS 50
+#define CAPTURE_DMA_BUF_COUNT 8 // 8 x 16 ms of DMA slack
+#define I2S_EVENT_QUEUE_LEN 16  // TX_DONE and RX_DONE events arrive every 16 ms each
+
+// Spectrum task (overlapped FFT frames -> smoothed bands for the visualizers)
+#define SPECTRUM_TASK_STACK 4096
+#define SPECTRUM_TASK_PRIORITY 3 // Below output; a late frame only delays the bars
+#define SPECTRUM_TASK_CORE 0
+#define SPECTRUM_HOP_SAMPLES (FFT_SIZE / 2) // 50% overlap: a frame every 8 ms
+#define SPECTRUM_ATTACK_MS 12               // Band smoothing time constants
+#define SPECTRUM_RELEASE_MS 180
+
+// Output task (mixes synth voices into fixed-size I2S DMA blocks)
+#define AUDIO_OUTPUT_BLOCK_FRAMES CAPTURE_BLOCK_SAMPLES // One DMA buffer, 16 ms
+#define AUDIO_OUTPUT_TASK_STACK 4096
+#define AUDIO_OUTPUT_TASK_PRIORITY 4 // Below capture, above network work
+#define AUDIO_OUTPUT_TASK_CORE 0
+#define AUDIO_COMMAND_QUEUE_LEN 8
+
+// Latest smoothed spectrum, published lock-free by the spectrum task
+struct SpectrumFrame
+{
+    float bands[NUM_BANDS]; // Smoothed band levels, 0-1
+    int64_t timestampUs;    // Capture time of the newest sample in the frame
+    int64_t onsetUs;        // Capture time of the last activity onset
+    uint32_t sequence;      // Frames analyzed since boot
+};
 
 // Beep parameters
 #define BEEP_FREQUENCY 1000 // 1kHz tone
@@ -38,6 +84,11 @@ public:
     bool init();
     void playBeep();
     void playBeep(uint16_t frequency, uint16_t duration);
+
+    // Non-blocking: notes are queued to the output task and play in the background
+    bool playSequence(const SynthNote *notes, uint8_t count);
+    bool playEarcon(Earcon earcon);
+    void wakeOutput(); // A streaming source has audio for the mixer
     void setVolume(uint8_t volume); // 0-100
     bool isPlaying();
     void stop();
@@ -48,26 +99,93 @@ public:
     bool isRecording();
     float getAudioLevel();
     void getFrequencyBands(float *bands, int numBands);
-    void processAudioData();
+
+    // Never blocks: returns false only if the writer kept the frame busy (keep the last one)
+    bool getSpectrumFrame(SpectrumFrame &frame);
+
+    // Capture ring access for block consumers (attach a reader, then peek/release)
+    AudioRingBuffer &getCaptureRing() { return captureRing; }
+    uint32_t getCaptureDmaOverflows() const { return dmaOverflows; }
+    void setAgcEnabled(bool enabled) { frontEnd.agcEnabled = enabled; }
+
+    // Activity gate: consumers can skip FFT/rendering/storage while this is false
+    bool isAudioActive() const { return vad.active; }
+    VadStats getVadStats() const { return audio_vad_stats(vad); }
 
 private:
     bool initialized;
-    bool playing;
+    volatile bool playing;
     bool recording;
-    uint8_t currentVolume;
+    volatile uint8_t currentVolume;
+
+    // Audio output
+    enum AudioCommandType : uint8_t
+    {
+        AUDIO_CMD_SEQUENCE,
+        AUDIO_CMD_EARCON,
+        AUDIO_CMD_WAKE,
+        AUDIO_CMD_STOP
+    };
+
+    struct AudioCommand
+    {
+        AudioCommandType type;
+        uint8_t noteCount;
+        Earcon earcon;
+        SynthNote notes[SYNTH_MAX_SEQUENCE_NOTES];
+    };
+
+    AudioSynth synth;
+    EarconStream earconStream;
+    QueueHandle_t commandQueue;
+    TaskHandle_t outputTask;
+    int32_t *outputBlock; // Mix accumulator, then 32-bit I2S slots (internal RAM)
+
+    static void outputTaskFunction(void *parameter);
+    void outputLoop();
+    bool sendCommand(const AudioCommand &command);
 
     // Audio buffers
-    int16_t *audioInputBuffer;
-    int16_t *audioOutputBuffer;
-    float *fftBuffer;
-    float frequencyBands[NUM_BANDS];
+    uint32_t *fftBuffer; // Power spectrum (AUDIO_FFT_BINS)
+    float frequencyBands[NUM_BANDS]; // Raw bands of the last analyzed frame
     float currentLevel;
 
-    void generateTone(uint16_t frequency, uint16_t duration);
-    bool configureI2SForOutput();
-    bool configureI2SForInput();
-    void performFFT(int16_t *samples, float *output);
-    void updateFrequencyBands(float *fftData);
+    // Continuous capture
+    AudioRingBuffer captureRing;
+    AudioRingReader levelReader;
+    AudioRingReader spectrumReader;
+    int32_t *captureDmaBuffer; // Raw 32-bit I2S frames for one block (internal RAM)
+    AudioFrontEnd frontEnd;    // Capture task only (except the AGC flag)
+    AudioVad vad;              // Capture task only
+    uint32_t spectrumFramesSkipped;
+
+    // Spectrum analysis (spectrum task only, except the published frame)
+    TaskHandle_t spectrumTask;
+    int16_t spectrumWindow[FFT_SIZE]; // Sliding analysis window
+    int16_t spectrumBlock[CAPTURE_BLOCK_SAMPLES];
+    float smoothedBands[NUM_BANDS];
+    float attackCoeff;
+    float releaseCoeff;
+    int64_t lastOnsetUs;
+    std::atomic<uint32_t> spectrumSeq; // Odd while spectrumFrame is being written
+    SpectrumFrame spectrumFrame;
+
+    TaskHandle_t captureTask;
+    QueueHandle_t i2sEventQueue;
+    volatile uint32_t dmaOverflows;
+
+    static void captureTaskFunction(void *parameter);
+    void captureLoop();
+    void drainI2SEvents();
+
+    static void spectrumTaskFunction(void *parameter);
+    void spectrumLoop();
+    void analyzeSpectrumFrame(bool active, int64_t timestampUs);
+    void publishSpectrum(int64_t timestampUs);
+
+    bool configureI2S();
+    void performFFT(const int16_t *samples, uint32_t *output);
+    void updateFrequencyBands(uint32_t *fftData);
 };
 
 extern AudioManager audioManager;
@@ -0,0 +1,33 @@
+#ifndef AUDIO_MATH_H
+#define AUDIO_MATH_H
+
+#include <stdint.h>
+
+// Integer helpers shared by the fixed-point audio modules
+
+// floor(sqrt(value)), bit by bit: no divide, no float
+static inline uint32_t isqrt32(uint32_t value)
+{
+    uint32_t result = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+#endif // AUDIO_MATH_H
@@ -0,0 +1,61 @@
+#ifndef AUDIO_ONSET_H
+#define AUDIO_ONSET_H
+
+#include <stdint.h>
+#include "audio_fft.h"
+
+// Spectral flux onset detection on the capture FFT (62.5 Hz bins at 16 kHz)
+#define ONSET_MIN_BIN 16             // Flux from 1 kHz up: claps/knocks are broadband, voice is not
+#define ONSET_HISTORY 16             // Frames in the adaptive threshold (256 ms)
+#define ONSET_THRESHOLD_RATIO_Q8 640 // Onset when flux > 2.5 x recent mean ...
+#define ONSET_MIN_FLUX 2000          // ... and above an absolute floor
+#define ONSET_REFRACTORY_MS 100
+#define ONSET_REFERENCE_REFRESH_BLOCKS 8 // Refresh the background spectrum every 128 ms of quiet
+
+// Clap pattern timing
+#define CLAP_MIN_GAP_MS 120 // Closer onsets are the same clap (echo, ring)
+#define CLAP_MAX_GAP_MS 600 // Pattern closes after this much quiet
+
+enum ClapPattern : uint8_t
+{
+    CLAP_NONE,
+    CLAP_DOUBLE,
+    CLAP_TRIPLE
+};
+
+struct OnsetDetector
+{
+    uint16_t prevMagnitude[AUDIO_FFT_BINS];
+    uint32_t fluxHistory[ONSET_HISTORY];
+    uint32_t fluxSum;
+    uint8_t historyPos;
+    int64_t lastOnsetUs;
+    uint32_t quietBlocks;
+
+    uint8_t clapCount;
+    int64_t lastClapUs;
+
+    uint32_t onsets;
+    uint32_t patterns;
+};
+
+void onset_init(OnsetDetector &det);
+
+// Feed one power spectrum (AUDIO_FFT_BINS). Returns true on an onset.
+bool onset_process(OnsetDetector &det, const uint32_t *power, int64_t timestampUs);
+
+// Keep the reference spectrum current without running detection (quiet frames)
+void onset_update_reference(OnsetDetector &det, const uint32_t *power);
+
+// Advance the clap pattern recognizer. Triple claps fire on the third clap,
+// double claps once CLAP_MAX_GAP_MS has passed without a third.
+ClapPattern onset_update_pattern(OnsetDetector &det, bool onset, int64_t nowUs);
+
+// One AUDIO_FFT_SIZE capture block through the whole chain: FFT and flux on
+// VAD-active blocks, an occasional reference refresh on quiet ones, then the
+// pattern recognizer. power is AUDIO_FFT_BINS of scratch. Used by the live
+// detector and by the host clip harness (test/test_clap_detector).
+ClapPattern onset_process_block(OnsetDetector &det, const int16_t *samples, bool active, int64_t timestampUs,
+                                uint32_t *power, bool *onset);
+
+#endif // AUDIO_ONSET_H
@@ -0,0 +1,104 @@
+#ifndef AUDIO_RECORDER_H
+#define AUDIO_RECORDER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "audio_ring_buffer.h"
+#include "ima_adpcm.h"
+
+// Double-buffered writer: each buffer is a whole number of flash sectors and
+// every write lands on a sector boundary (the WAV header is part of buffer 0)
+#define RECORD_SECTOR_BYTES 4096
+#define RECORD_WRITE_BUFFER_BYTES (4 * RECORD_SECTOR_BYTES) // 2 s of ADPCM, 512 ms of PCM
+#define RECORD_PATH_MAX 64
+
+#define RECORD_ENCODER_TASK_STACK 4096
+#define RECORD_ENCODER_TASK_PRIORITY 3 // Below capture/output, must keep up with the ring
+#define RECORD_WRITER_TASK_STACK 4096
+#define RECORD_WRITER_TASK_PRIORITY 1 // Flash writes may block for erases
+#define RECORD_TASK_CORE 0
+
+enum RecordFormat : uint8_t
+{
+    RECORD_FORMAT_IMA_ADPCM, // 4:1, 256-byte blocks of 505 samples
+    RECORD_FORMAT_PCM16
+};
+
+struct RecorderStats
+{
+    uint32_t samplesRecorded;
+    uint32_t bytesWritten;
+    uint32_t captureOverruns; // Capture blocks lost because the encoder fell behind
+    uint32_t silentBlocksSkipped;
+    uint32_t writerStalls;    // Encoder waited for the writer to free a buffer
+    uint32_t maxWriteMs;      // Slowest single buffer write
+    float throughputKBps;     // Sustained write throughput (bytes / time spent writing)
+};
+
+class AudioRecorder
+{
+public:
+    AudioRecorder();
+    bool init();
+
+    // Non-blocking: start returns once the file is created, stop at once. The
+    // encoder drains and flushes in the background, then calls onStopped from
+    // its own task; the writer finishes and patches the header after that.
+    bool start(const char *path, RecordFormat format = RECORD_FORMAT_IMA_ADPCM);
+    void stop(void (*onStopped)() = nullptr);
+    bool isRecording() const { return recording; }
+    void setSkipSilence(bool skip) { skipSilence = skip; } // Voice-activated: store active blocks only
+    RecorderStats getStats() const { return stats; }
+
+private:
+    struct WriteJob
+    {
+        uint8_t buffer;
+        uint32_t length;
+        bool finish; // Last buffer: patch the header and close
+    };
+
+    uint8_t *buffers[2];
+    SemaphoreHandle_t bufferFree[2];
+    uint8_t activeBuffer;
+    uint32_t bufferFill;
+
+    int16_t *adpcmStaging; // Samples waiting for a full ADPCM block
+    uint32_t stagingCount;
+    ImaAdpcmState adpcmState;
+
+    File file;
+    char path[RECORD_PATH_MAX];
+    RecordFormat format;
+    AudioRingReader reader;
+    volatile bool recording;
+    volatile bool stopRequested;
+    volatile bool skipSilence;
+    TaskHandle_t encoderTask;
+    TaskHandle_t writerTask;
+    QueueHandle_t writeQueue;
+    void (*volatile stopCallback)();
+    RecorderStats stats;
+    uint64_t writeUs;
+
+    static void encoderTaskFunction(void *parameter);
+    static void writerTaskFunction(void *parameter);
+    void encoderLoop();
+    void writerLoop();
+
+    void append(const uint8_t *data, uint32_t length);
+    void submitBuffer(bool finish);
+    void recordBlock(const AudioBlock *block);
+    void encodeBlock(const int16_t *samples, int count);
+    void flushStaging();
+    uint32_t buildHeader(uint8_t *header, uint32_t dataBytes);
+    uint32_t headerSize() const;
+};
+
+extern AudioRecorder audioRecorder;
+
+#endif // AUDIO_RECORDER_H
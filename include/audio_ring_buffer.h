@@ -0,0 +1,63 @@
+#ifndef AUDIO_RING_BUFFER_H
+#define AUDIO_RING_BUFFER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Capture ring geometry
+#define CAPTURE_BLOCK_SAMPLES 256 // 16 ms at 16 kHz, one FFT frame
+#define CAPTURE_RING_BLOCKS 32    // ~0.5 s of history (power of two)
+
+// AudioBlock flags (set by the capture task's activity detector)
+#define AUDIO_BLOCK_ACTIVE 0x01 // Voice or onset energy (including hangover)
+#define AUDIO_BLOCK_ONSET 0x02  // First block of an active period
+
+// One block of captured audio, written in place by the capture task
+struct AudioBlock
+{
+    int64_t timestampUs; // esp_timer time the block finished capturing
+    uint32_t sequence;   // Block number, invalid while being written
+    uint16_t rms;        // Q15 level of the samples, computed once by the capture front end
+    uint16_t peak;
+    uint8_t flags;       // AUDIO_BLOCK_*
+    int16_t samples[CAPTURE_BLOCK_SAMPLES];
+};
+
+// Per-consumer read cursor. Each consumer (level meter, spectrum, recorder)
+// owns one, so every producer/consumer pair is single-producer/single-consumer.
+struct AudioRingReader
+{
+    uint32_t next;     // Sequence number of the next block to read
+    uint32_t overruns; // Blocks skipped because this reader fell behind
+};
+
+// Lock-free block ring in internal RAM. The producer never waits for readers;
+// a reader that falls behind skips ahead and counts the lost blocks.
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer();
+    bool init();
+
+    // Producer (capture task only)
+    AudioBlock *beginWrite();
+    void commitWrite(int64_t timestampUs);
+
+    // Consumers: peek returns the next block without copying (or nullptr if none
+    // is ready); release returns false if the block was overwritten while in use
+    void attachReader(AudioRingReader &reader);
+    const AudioBlock *peek(AudioRingReader &reader);
+    bool release(AudioRingReader &reader);
+    uint32_t available(const AudioRingReader &reader) const;
+
+    // Drop all but the newest ready block (consumers that only want the latest frame)
+    void seekLatest(AudioRingReader &reader);
+
+    uint32_t getBlocksWritten() const { return head.load(std::memory_order_acquire); }
+
+private:
+    AudioBlock *blocks;
+    std::atomic<uint32_t> head; // Number of committed blocks
+};
+
+#endif // AUDIO_RING_BUFFER_H
@@ -0,0 +1,103 @@
+#ifndef AUDIO_STREAM_PLAYER_H
+#define AUDIO_STREAM_PLAYER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+class AudioGenerator;
+class AudioFileSource;
+class AudioFileSourceBuffer;
+class StreamPcmOutput;
+
+// Pipeline: source (HTTP / LittleFS) -> source buffer -> MP3/AAC decoder ->
+// resampler -> PCM ring -> output task mixer -> I2S
+#define STREAM_SOURCE_BUFFER_BYTES (32 * 1024) // Compressed data buffer (PSRAM)
+#define STREAM_PCM_RING_SAMPLES 8192           // 512 ms of decoded audio at 16 kHz (power of two)
+#define STREAM_PREBUFFER_HIGH 4096             // Start (or resume after underrun) at 256 ms buffered
+#define STREAM_PATH_MAX 192
+
+#define STREAM_TASK_STACK 8192
+#define STREAM_TASK_PRIORITY 2 // Below audio output/capture, decode has 0.5 s of slack
+#define STREAM_TASK_CORE 0
+#define STREAM_STATS_INTERVAL_MS 5000
+
+enum StreamSourceType : uint8_t
+{
+    STREAM_SOURCE_HTTP,
+    STREAM_SOURCE_FILE
+};
+
+struct StreamStats
+{
+    uint32_t underruns;     // Output needed audio while the ring was empty mid-stream
+    uint32_t overruns;      // Decoder blocked on a full PCM ring (back-pressure, no loss)
+    uint32_t bufferedSamples;
+    uint32_t sourceRate;    // Decoder output rate before resampling
+    float decodeCpuPercent; // Decoder share of one core over the last stats interval
+};
+
+class AudioStreamPlayer
+{
+public:
+    AudioStreamPlayer();
+    bool init();
+
+    // Non-blocking: the request is handed to the pipeline task
+    bool playUrl(const char *url);   // Plain http:// (MP3 or ADTS AAC)
+    bool playFile(const char *path); // LittleFS path
+    void stop();
+    bool isActive() const { return active; }
+    StreamStats getStats();
+
+    // Output task side: add up to frames of decoded PCM into the mix accumulator
+    void mix(int32_t *accumulator, int frames);
+
+    // Decoder side (called by StreamPcmOutput)
+    uint32_t pcmFree() const;
+    void pcmPush(int16_t sample);
+    void countOverrun() { overruns++; }
+
+private:
+    struct StreamRequest
+    {
+        bool stop;
+        StreamSourceType type;
+        char path[STREAM_PATH_MAX];
+    };
+
+    // Decoded PCM ring (single producer: pipeline task, single consumer: output task)
+    int16_t *pcmRing;
+    std::atomic<uint32_t> pcmHead;
+    std::atomic<uint32_t> pcmTail;
+    std::atomic<uint32_t> pcmStart; // First sample of the current stream; older data is skipped
+    bool prebuffering;              // Output task only
+
+    uint8_t *sourceBuffer;
+    QueueHandle_t requestQueue;
+    TaskHandle_t pipelineTask;
+    volatile bool active;   // Stream audible (decoding or draining the ring)
+    volatile bool decoding; // Decoder still producing
+    bool holdingRadio;      // HTTP source open: WiFi stays out of power save
+
+    AudioFileSource *source;
+    AudioFileSourceBuffer *bufferedSource;
+    AudioGenerator *generator;
+    StreamPcmOutput *output;
+
+    volatile uint32_t underruns;
+    volatile uint32_t overruns;
+    volatile float decodeCpuPercent;
+
+    static void pipelineTaskFunction(void *parameter);
+    void pipelineLoop();
+    bool open(const StreamRequest &request);
+    void close();
+    bool request(StreamSourceType type, const char *path);
+};
+
+extern AudioStreamPlayer audioStreamPlayer;
+
+#endif // AUDIO_STREAM_PLAYER_H
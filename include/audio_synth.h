@@ -0,0 +1,105 @@
+#ifndef AUDIO_SYNTH_H
+#define AUDIO_SYNTH_H
+
+#include <Arduino.h>
+
+// Synth configuration
+#define SYNTH_VOICES 4
+#define SYNTH_WAVETABLE_BITS 8
+#define SYNTH_WAVETABLE_SIZE (1 << SYNTH_WAVETABLE_BITS)
+#define SYNTH_MAX_SEQUENCE_NOTES 8 // Notes per sequence command
+#define SYNTH_MAX_PENDING_NOTES 16 // Scheduled notes waiting for their start time
+
+enum SynthWaveform : uint8_t
+{
+    WAVE_SINE,
+    WAVE_SQUARE
+};
+
+// ADSR envelope (sustain as a percentage of the note level)
+struct SynthEnvelope
+{
+    uint16_t attackMs;
+    uint16_t decayMs;
+    uint8_t sustainPercent;
+    uint16_t releaseMs;
+};
+
+// Short click-free envelope for UI beeps
+#define SYNTH_DEFAULT_ENVELOPE {5, 20, 80, 15}
+
+// One note of a sequence. The gate (durationMs) is followed by the release.
+struct SynthNote
+{
+    uint16_t startMs;    // Offset from the start of the sequence
+    uint16_t frequency;  // Hz
+    uint16_t durationMs; // Gate time
+    uint8_t level;       // 0-100, before master volume
+    SynthWaveform waveform;
+};
+
+// Fixed-point wavetable synth: phase-accumulator oscillators with linear
+// interpolation, per-voice ADSR and a sample-accurate note sequencer.
+// Not thread safe; owned by the audio output task.
+class AudioSynth
+{
+public:
+    AudioSynth();
+    void init(uint32_t sampleRate);
+
+    // Schedule notes relative to the current render position
+    bool schedule(const SynthNote *notes, uint8_t count, const SynthEnvelope &envelope);
+    void stopAll(); // Release sounding voices and drop pending notes
+    bool isActive() const;
+
+    // Add the next frames of output (Q15 per voice) into a mix accumulator
+    void mix(int32_t *accumulator, int frames);
+
+private:
+    enum Stage : uint8_t
+    {
+        STAGE_IDLE,
+        STAGE_ATTACK,
+        STAGE_DECAY,
+        STAGE_SUSTAIN,
+        STAGE_RELEASE
+    };
+
+    struct Voice
+    {
+        Stage stage;
+        SynthWaveform waveform;
+        uint32_t phase;
+        uint32_t phaseInc;
+        int32_t gain;          // Note level, Q15
+        int32_t level;         // Envelope level, Q24
+        int32_t attackInc;
+        int32_t decayDec;
+        int32_t sustainLevel;
+        uint32_t releaseFrames;
+        int32_t releaseDec;
+        uint32_t startDelay;    // Frames of silence before the note begins (mid-block start)
+        uint32_t gateRemaining; // Frames until release
+        uint32_t age;
+    };
+
+    struct PendingNote
+    {
+        SynthNote note;
+        SynthEnvelope envelope;
+        uint32_t startFrame;
+    };
+
+    Voice voices[SYNTH_VOICES];
+    PendingNote pending[SYNTH_MAX_PENDING_NOTES];
+    uint8_t pendingCount;
+    uint32_t sampleRate;
+    uint32_t clock; // Frames rendered since init
+    uint32_t noteCounter;
+
+    uint32_t msToFrames(uint32_t ms) const;
+    void startVoice(const PendingNote &pendingNote, uint32_t offset);
+    void renderVoice(Voice &voice, int32_t *accumulator, int frames);
+};
+
+#endif // AUDIO_SYNTH_H
@@ -0,0 +1,46 @@
+#ifndef AUDIO_VAD_H
+#define AUDIO_VAD_H
+
+#include <stdint.h>
+
+// Energy + zero-crossing voice/onset activity detector, one decision per capture block.
+// Ratios are block RMS over the adaptive noise floor (Q8).
+#define VAD_ONSET_RATIO_Q8 (4 << 8) // +12 dB: anything this loud is interesting
+#define VAD_VOICE_RATIO_Q8 (2 << 8) // +6 dB: interesting if the ZCR looks like voice
+#define VAD_ZCR_MIN 4               // Crossings per 256 samples (~125 Hz at 16 kHz)
+#define VAD_ZCR_MAX 80              // Above this it is hiss, not voice
+#define VAD_MIN_RMS 40              // Absolute floor (Q15), ignore the mic self-noise
+#define VAD_HANGOVER_BLOCKS 15      // Stay active 240 ms after the last trigger
+#define VAD_INITIAL_FLOOR 100
+
+struct VadStats
+{
+    uint32_t blocks;
+    uint32_t activeBlocks;
+    uint32_t onsets;      // Inactive -> active transitions
+    uint16_t noiseFloor;  // Current adaptive floor (Q15 RMS)
+    float dutyCycle;      // activeBlocks / blocks
+};
+
+struct AudioVad
+{
+    uint32_t noiseFloorQ8;
+    uint16_t hangover;
+    bool active;
+    uint32_t blocks;
+    uint32_t activeBlocks;
+    uint32_t onsets;
+};
+
+void audio_vad_init(AudioVad &vad);
+
+// Zero crossings in a block
+uint16_t audio_vad_zcr(const int16_t *samples, int count);
+
+// Classify one block (rms from the front end); returns true while active.
+// *onset is set on the block that opens an active period.
+bool audio_vad_process(AudioVad &vad, const int16_t *samples, int count, uint16_t rms, bool *onset);
+
+VadStats audio_vad_stats(const AudioVad &vad);
+
+#endif // AUDIO_VAD_H
@@ -0,0 +1,35 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+
+// Boot stages, timed in esp_timer microseconds (time since reset)
+enum BootStage : uint8_t
+{
+    BOOT_STAGE_NVS,
+    BOOT_STAGE_DISPLAY,
+    BOOT_STAGE_UI,
+    BOOT_STAGE_BUTTONS,     // Ends when the UI is interactive
+    BOOT_STAGE_AUDIO,
+    BOOT_STAGE_CHIME,       // Startup earcon audible
+    BOOT_STAGE_WIFI,        // connect() -> GOT_IP
+    BOOT_STAGE_TOKEN,       // Spotify access token
+    BOOT_STAGE_FIRST_POLL,  // First playback poll on screen: a track, an empty player or the error
+    BOOT_STAGE_COUNT
+};
+
+#define BOOT_TIMELINE_TIMEOUT_MS 60000 // Print whatever finished if a stage never does
+
+// Any task may begin or end a stage, but not concurrently with another call
+// for the same stage. A stage that spans tasks (first poll: BootNet begins it,
+// the loop ends it) relies on the hand-off between them, the boot event bits,
+// to order the two calls.
+void boot_stage_begin(BootStage stage);
+void boot_stage_end(BootStage stage);
+void boot_stage_skip(BootStage stage); // Won't run this boot (e.g. no chime without audio)
+bool boot_stage_done(BootStage stage);  // Ended or skipped
+
+bool boot_timeline_complete();
+void boot_timeline_print();
+
+#endif
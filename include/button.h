@@ -8,29 +8,30 @@
 #define BUTTON_2_PIN 2 // Next Track
 #define BUTTON_3_PIN 3 // Previous Track
 
-// Triple press settings
-#define TRIPLE_PRESS_WINDOW 800      // milliseconds window for triple press
-#define TRIPLE_PRESS_MIN_INTERVAL 50 // minimum time between presses
+// Edge input: GPIO interrupts queue timestamped edges, debounced on their timestamps
+#define BUTTON_EDGE_QUEUE_LEN 32        // ~5 s of hammering on all buttons while the loop is blocked
+#define BUTTON_DEBOUNCE_LOCKOUT_US 30000 // Edges this soon after an accepted transition are bounce
+#define BUTTON_LATE_DISPATCH_MS 100      // Log presses the loop picked up later than this
 
 // Button structure
 struct Button
 {
     uint8_t pin;
     bool currentState;
-    bool lastState;
-    unsigned long lastDebounceTime;
+    bool lastState;         // Level reported by the latest edge (may still be bouncing)
+    int64_t lastEdgeUs;     // Timestamp of the latest edge
+    int64_t lastAcceptedUs; // Timestamp of the last debounced transition
     unsigned long pressTime;
     bool isPressed;
     bool wasPressed;
+};
 
-    // Triple press detection
-    unsigned long lastPressTime;
-    int pressCount;
-    unsigned long firstPressTime;
-
-    // Delayed single press handling
-    bool hasPendingSinglePress;
-    unsigned long pendingSinglePressTime;
+// One GPIO edge, captured in the interrupt handler
+struct ButtonEdge
+{
+    int64_t timeUs;
+    uint8_t button;
+    bool pressed;
 };
 
 // Function declarations
@@ -40,13 +41,6 @@ void handleSpotifyControls();
 bool isButtonPressed(uint8_t buttonIndex);
 bool wasButtonJustPressed(uint8_t buttonIndex);
 bool wasButtonJustReleased(uint8_t buttonIndex);
-bool isButtonLongPressed(uint8_t buttonIndex);
-bool isButtonTriplePressed(uint8_t buttonIndex);
-void processPendingSinglePresses();
-
-// Screen-specific button handlers
-void handleMainScreenButtons();
-void handleDeviceScreenButtons();
 
 // Spotify control functions
 void handlePlayPause();
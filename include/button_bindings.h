@@ -0,0 +1,46 @@
+#ifndef BUTTON_BINDINGS_H
+#define BUTTON_BINDINGS_H
+
+#include "button_gestures.h"
+#include "ui_screen.h"
+
+// Gesture actions, defined in button.cpp (and by the host tests)
+void gestureOpenDevices(const GestureEvent &event);
+void gestureOpenSpectrum(const GestureEvent &event);
+void gestureBackToMain(const GestureEvent &event);
+void gesturePlayPause(const GestureEvent &event);
+void gestureNextTrack(const GestureEvent &event);
+void gesturePreviousTrack(const GestureEvent &event);
+void gestureSelectDevice(const GestureEvent &event);
+void gestureDeviceDown(const GestureEvent &event);
+void gestureDeviceUp(const GestureEvent &event);
+void gestureVolumeUp(const GestureEvent &event);
+void gestureVolumeDown(const GestureEvent &event);
+void gestureToggleRecording(const GestureEvent &event);
+
+// Gestures per screen. A tap fires as soon as no other gesture on the same
+// button can still claim it: on press, on release (long press bound), after
+// the chord window (chord bound) or after the double window (double bound).
+// Keep the on-screen instructions (lvgl_device_screen.cpp) in step with this.
+static const GestureBinding gestureBindings[] = {
+    {SCREEN_MAIN, GESTURE_SINGLE, GESTURE_BUTTON(0), gesturePlayPause, "play/pause"},
+    {SCREEN_MAIN, GESTURE_LONG, GESTURE_BUTTON(0), gestureOpenDevices, "devices"},
+    {SCREEN_MAIN, GESTURE_SINGLE, GESTURE_BUTTON(1), gestureNextTrack, "next"},
+    {SCREEN_MAIN, GESTURE_HOLD_REPEAT, GESTURE_BUTTON(1), gestureVolumeUp, "volume up"},
+    {SCREEN_MAIN, GESTURE_SINGLE, GESTURE_BUTTON(2), gesturePreviousTrack, "previous"},
+    {SCREEN_MAIN, GESTURE_HOLD_REPEAT, GESTURE_BUTTON(2), gestureVolumeDown, "volume down"},
+    {SCREEN_MAIN, GESTURE_CHORD, GESTURE_BUTTON(1) | GESTURE_BUTTON(2), gestureOpenSpectrum, "spectrum"},
+    {SCREEN_MAIN, GESTURE_CHORD, GESTURE_BUTTON(0) | GESTURE_BUTTON(2), gestureToggleRecording, "record"},
+
+    {SCREEN_DEVICES, GESTURE_SINGLE, GESTURE_BUTTON(0), gestureSelectDevice, "select"},
+    {SCREEN_DEVICES, GESTURE_LONG, GESTURE_BUTTON(0), gestureBackToMain, "back"},
+    {SCREEN_DEVICES, GESTURE_HOLD_REPEAT, GESTURE_BUTTON(1), gestureDeviceDown, "down"},
+    {SCREEN_DEVICES, GESTURE_HOLD_REPEAT, GESTURE_BUTTON(2), gestureDeviceUp, "up"},
+
+    {SCREEN_SPECTRUM, GESTURE_LONG, GESTURE_BUTTON(0), gestureBackToMain, "back"},
+    {SCREEN_SPECTRUM, GESTURE_CHORD, GESTURE_BUTTON(1) | GESTURE_BUTTON(2), gestureBackToMain, "back"},
+};
+
+#define GESTURE_BINDING_COUNT (sizeof(gestureBindings) / sizeof(gestureBindings[0]))
+
+#endif // BUTTON_BINDINGS_H
@@ -0,0 +1,81 @@
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <stdint.h>
+
+// Table-driven gesture recognition over debounced button transitions.
+// Pure logic on caller-supplied millisecond timestamps; the clock and the log
+// are injected, so it behaves the same on queued past edges, in virtual time
+// and in the host tests.
+#define GESTURE_MAX_BUTTONS 3
+#define GESTURE_CHORD_WINDOW_MS 80   // Second button of a chord must follow within this
+#define GESTURE_DOUBLE_WINDOW_MS 300 // Release to second press
+#define GESTURE_LONG_PRESS_MS 600
+#define GESTURE_REPEAT_DELAY_MS 400 // First auto-repeat of a held button (when it fired on press)
+#define GESTURE_REPEAT_INTERVAL_MS 150
+
+#define GESTURE_BUTTON(n) ((uint8_t)(1u << (n)))
+
+enum GestureType : uint8_t
+{
+    GESTURE_SINGLE,      // Fires on press when nothing else can claim it, else on resolution
+    GESTURE_DOUBLE,      // Two presses within GESTURE_DOUBLE_WINDOW_MS
+    GESTURE_LONG,        // Fires while held, at GESTURE_LONG_PRESS_MS
+    GESTURE_HOLD_REPEAT, // Fires on press (at the long press threshold if a single is also
+                         // bound), then repeats while held (event.repeat counts up)
+    GESTURE_CHORD        // Two buttons pressed together (buttons holds both bits)
+};
+
+struct GestureEvent
+{
+    GestureType type;
+    uint8_t buttons;
+    uint16_t repeat;
+    uint32_t timeMs; // Virtual time the gesture was recognized
+};
+
+typedef void (*GestureAction)(const GestureEvent &event);
+
+struct GestureBinding
+{
+    uint8_t screen; // Screen the binding is active on
+    GestureType type;
+    uint8_t buttons; // GESTURE_BUTTON mask (two bits for chords)
+    GestureAction action;
+    const char *name;
+};
+
+struct GestureButton
+{
+    uint8_t phase;
+    uint32_t pressMs;
+    uint32_t releaseMs;
+    uint32_t nextRepeatMs;
+    uint16_t repeat;
+};
+
+struct GestureEngine
+{
+    const GestureBinding *bindings;
+    uint8_t bindingCount;
+    uint8_t (*screenProvider)(); // Queried before every decision; a change cancels gestures in flight
+    uint32_t (*clockMs)();            // Time source for gesture_poll()
+    void (*logger)(const char *name); // Called once per recognized gesture (not per repeat), may be null
+    uint8_t screen;
+    GestureButton buttons[GESTURE_MAX_BUTTONS];
+    uint32_t gesturesFired;
+};
+
+void gesture_init(GestureEngine &engine, const GestureBinding *bindings, uint8_t bindingCount,
+                  uint8_t (*screenProvider)(), uint32_t (*clockMs)(), void (*logger)(const char *name));
+
+// Feed one debounced transition. Timeouts up to timeMs are resolved first.
+void gesture_input(GestureEngine &engine, uint8_t button, bool pressed, uint32_t timeMs);
+
+// Resolve timeouts (long press, repeat, chord/double windows) up to nowMs
+void gesture_tick(GestureEngine &engine, uint32_t nowMs);
+
+// gesture_tick() up to the injected clock
+void gesture_poll(GestureEngine &engine);
+
+#endif // BUTTON_GESTURES_H
@@ -0,0 +1,53 @@
+#ifndef CLAP_DETECTOR_H
+#define CLAP_DETECTOR_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "audio_onset.h"
+#include "audio_ring_buffer.h"
+
+#define CLAP_TASK_STACK 6144 // FFT work buffer lives on the stack
+#define CLAP_TASK_PRIORITY 3
+#define CLAP_TASK_CORE 0
+#define CLAP_OUTPUT_GUARD_MS 250        // Ignore onsets while (and just after) the speaker plays
+#define CLAP_STATS_INTERVAL_MS 30000
+
+struct ClapStats
+{
+    uint32_t onsets;
+    uint32_t patterns;
+    uint32_t suppressed;   // Onsets ignored because audio output was active
+    uint32_t maxLatencyUs; // Capture end of block -> onset decision
+    float cpuPercent;      // Detector share of core 0 over the last stats interval
+};
+
+// Hands-free control: double clap = play/pause, triple clap = next track.
+// Runs on its own capture ring reader; the main loop picks up recognized patterns.
+class ClapDetector
+{
+public:
+    ClapDetector();
+    bool init();
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    ClapPattern takePattern() { return (ClapPattern)pending.exchange(CLAP_NONE); }
+    ClapStats getStats() const { return stats; }
+
+private:
+    OnsetDetector detector;
+    AudioRingReader reader;
+    uint32_t *power;
+    TaskHandle_t task;
+    std::atomic<uint8_t> pending;
+    volatile bool enabled_;
+    int64_t outputGuardUntilUs;
+    ClapStats stats;
+
+    static void taskFunction(void *parameter);
+    void taskLoop();
+};
+
+extern ClapDetector clapDetector;
+
+#endif // CLAP_DETECTOR_H
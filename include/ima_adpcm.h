@@ -0,0 +1,29 @@
+#ifndef IMA_ADPCM_H
+#define IMA_ADPCM_H
+
+#include <Arduino.h>
+
+// IMA/DVI ADPCM (4 bits per sample, low nibble first as in WAV)
+
+// WAV block layout (mono): 4-byte header (first sample, step index) + 2 samples per byte
+#define IMA_ADPCM_BLOCK_BYTES 256
+#define IMA_ADPCM_SAMPLES_PER_BLOCK ((IMA_ADPCM_BLOCK_BYTES - 4) * 2 + 1) // 505
+struct ImaAdpcmState
+{
+    int16_t predictor;
+    uint8_t stepIndex;
+};
+
+void ima_adpcm_reset(ImaAdpcmState &state);
+
+// Decode one nibble, returns the 16-bit sample
+int16_t ima_adpcm_decode_nibble(ImaAdpcmState &state, uint8_t nibble);
+
+// Encode one sample, updating the state exactly as the decoder will
+uint8_t ima_adpcm_encode_sample(ImaAdpcmState &state, int16_t sample);
+
+// Encode IMA_ADPCM_SAMPLES_PER_BLOCK samples into one IMA_ADPCM_BLOCK_BYTES WAV block.
+// The step index carries over between blocks; the predictor restarts at each block.
+void ima_adpcm_encode_block(ImaAdpcmState &state, const int16_t *samples, uint8_t *block);
+
+#endif // IMA_ADPCM_H
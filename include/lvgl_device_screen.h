@@ -2,16 +2,24 @@
 #define LVGL_DEVICE_SCREEN_H
 
 #include <lvgl.h>
+#include <vector>
 #include "spotify_manager.h"
 
+// Virtualized device list geometry: only this many row objects exist,
+// regardless of how many devices the account reports
+#define DEVICE_LIST_VISIBLE_ROWS 6
+#define DEVICE_LIST_ROW_PITCH 25
+#define DEVICE_LIST_TOP_PAD 6
+
 // Device screen management
 extern lv_obj_t *device_screen;
 
 void lvgl_create_device_screen();
-void lvgl_update_device_list(SpotifyDevice devices[], int deviceCount);
+void lvgl_update_device_list(const std::vector<SpotifyDevice> &devices);
 void lvgl_navigate_devices(int direction); // -1 for up, 1 for down
 void lvgl_select_current_device();
 void lvgl_show_device_screen();
+void lvgl_process_device_updates(); // Call from main loop
 void lvgl_hide_device_screen();
 void lvgl_show_main_screen();
 
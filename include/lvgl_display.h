@@ -10,4 +10,7 @@ void lvgl_init_display();
 // Display flush callback
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
 
+// Total pixels flushed to the panel since boot
+uint32_t lvgl_get_flushed_pixels();
+
 #endif // LVGL_DISPLAY_H 
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef LVGL_PLAYBACK_PROGRESS_H
+#define LVGL_PLAYBACK_PROGRESS_H
+
+#include <lvgl.h>
+#include "spotify_manager.h"
+
+// Progress bar geometry (bar value range is one unit per pixel)
+#define PROGRESS_BAR_WIDTH 220
+#define PROGRESS_BAR_HEIGHT 4
+
+// Drift handling for the local playback clock
+#define PROGRESS_SNAP_THRESHOLD_MS 1500 // Larger errors are treated as seeks and snapped
+#define PROGRESS_MIN_SLEW_MS 1000       // Minimum time over which small errors are smoothed away
+#define PROGRESS_STATS_INTERVAL_MS 60000
+
+// Playback progress (bar + elapsed/remaining labels on the main screen)
+void lvgl_create_playback_progress(lv_obj_t *parent);
+void lvgl_sync_playback_progress(const SpotifyTrack& track, bool trackValid);
+void lvgl_update_playback_progress();
+
+#endif // LVGL_PLAYBACK_PROGRESS_H
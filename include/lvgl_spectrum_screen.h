@@ -0,0 +1,46 @@
+#ifndef LVGL_SPECTRUM_SCREEN_H
+#define LVGL_SPECTRUM_SCREEN_H
+
+#include <lvgl.h>
+
+// Spectrum plot geometry (one bar per octave band)
+#define SPECTRUM_PLOT_WIDTH 296
+#define SPECTRUM_PLOT_HEIGHT 160
+#define SPECTRUM_BAR_GAP 7
+#define SPECTRUM_PEAK_HEIGHT 2
+
+// Frame pacing: 60 FPS, matching the LVGL refresh period. Analysis runs at its
+// own 125 Hz hop rate; each frame samples the newest smoothed band vector.
+#define SPECTRUM_FRAME_MS 16
+#define SPECTRUM_STATS_INTERVAL_MS 5000
+
+// Peak hold: stay for a while, then fall with constant acceleration (Q8 px)
+#define SPECTRUM_PEAK_HOLD_FRAMES 20
+#define SPECTRUM_PEAK_GRAVITY_Q8 20
+
+// Sound-to-bar latency: time from the capture block that carried an activity
+// onset to the first frame where a bar rises at least this much
+#define SPECTRUM_LATENCY_RISE_PX 6
+
+struct SpectrumRenderStats
+{
+    uint32_t frames;
+    uint32_t invalidatedPx; // Sum of areas passed to LVGL since boot
+    uint32_t idleFrames;    // Frames where nothing changed
+    uint32_t maxFrameUs;    // Slowest frame step (band read + invalidation)
+    uint32_t staleFrames;   // No newer analysis frame than the last one rendered
+    uint32_t latencySamples;
+    uint32_t latencyMinUs;
+    uint32_t latencyMaxUs;
+    uint64_t latencySumUs;
+};
+
+// Spectrum screen management
+extern lv_obj_t *spectrum_screen;
+
+void lvgl_create_spectrum_screen();
+void lvgl_show_spectrum_screen(); // Starts the microphone and the frame timer
+void lvgl_hide_spectrum_screen(); // Stops both; the caller loads the next screen
+const SpectrumRenderStats &lvgl_get_spectrum_stats();
+
+#endif // LVGL_SPECTRUM_SCREEN_H
@@ -3,7 +3,20 @@
 
 #include "spotify_manager.h"
 
+#define TRACK_INFO_STATS_INTERVAL_MS 60000
+
+// Render statistics for the track info view model
+struct TrackInfoRenderStats
+{
+    uint32_t updates;            // Calls to lvgl_update_track_info
+    uint32_t idleUpdates;        // Updates that issued no LVGL mutation
+    uint32_t widgetMutations;    // Total LVGL setter calls issued
+    uint32_t lastInvalidatedPx;  // Pixels invalidated by the most recent update
+    uint32_t totalInvalidatedPx; // Pixels invalidated since boot
+};
+
 // Track information display functions
 void lvgl_update_track_info(const SpotifyTrack& track, bool trackValid);
+const TrackInfoRenderStats& lvgl_get_track_info_stats();
 
-#endif // LVGL_TRACK_INFO_H 
\ No newline at end of file
+#endif // LVGL_TRACK_INFO_H
@@ -7,6 +7,9 @@
 #include "lvgl_album_art.h"
 #include "lvgl_track_info.h"
 #include "lvgl_device_screen.h"
+#include "lvgl_playback_progress.h"
+#include "lvgl_spectrum_screen.h"
+#include "lvgl_volume_overlay.h"
 
 // Main initialization function
 void lvgl_ui_init();
@@ -2,13 +2,7 @@
 #define LVGL_UI_COMPONENTS_H
 
 #include <lvgl.h>
-
-// Screen management
-enum UIScreen
-{
-    SCREEN_MAIN = 0,
-    SCREEN_DEVICES = 1
-};
+#include "ui_screen.h"
 
 extern UIScreen currentScreen;
 
@@ -23,7 +17,7 @@ extern lv_obj_t *wifi_status_label;
 
 // UI creation and management
 void lvgl_create_ui();
-void lvgl_update_wifi_status(bool connected);
+void lvgl_update_wifi_status(bool connected, const char *detail = nullptr);
 void lvgl_switch_screen(UIScreen screen);
 
 #endif // LVGL_UI_COMPONENTS_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef LVGL_VOLUME_OVERLAY_H
+#define LVGL_VOLUME_OVERLAY_H
+
+#include <lvgl.h>
+#include "spotify_manager.h"
+
+// Overlay geometry (top layer, shown over the current screen while adjusting)
+#define VOLUME_OVERLAY_WIDTH 220
+#define VOLUME_OVERLAY_HEIGHT 40
+#define VOLUME_OVERLAY_TIMEOUT_MS 1500 // Hide after this long without a change
+#define VOLUME_FRAME_MS 16
+
+// Hold-to-repeat acceleration: the step grows by 1% every few repeats
+#define VOLUME_STEP_ACCEL_REPEATS 4
+#define VOLUME_MAX_STEP 5
+#define VOLUME_DEFAULT 50 // Starting point before the first playback state arrives
+
+// Polled volumes lag the rate-limited PUTs; ignore them for a while after a local change
+#define VOLUME_REMOTE_HOLDOFF_MS 4000
+
+// Volume control: local value and overlay update at once, the Spotify API
+// receives the latest value through the SpotifyManager worker (rate limited)
+void lvgl_create_volume_overlay();
+void lvgl_adjust_volume(int direction, uint16_t repeat); // direction +1/-1, repeat from hold-repeat
+void lvgl_sync_volume(const SpotifyTrack &track, bool trackValid);
+
+#endif // LVGL_VOLUME_OVERLAY_H
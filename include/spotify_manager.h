@@ -5,6 +5,11 @@
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <vector>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 
 // Spotify API Configuration
 #define SPOTIFY_CLIENT_ID "11629778e4d44ed8a93c81e9aff8a1a8"
@@ -15,6 +20,13 @@
 #define SPOTIFY_TOKEN_URL "https://accounts.spotify.com/api/token"
 #define SPOTIFY_API_URL "https://api.spotify.com/v1"
 
+// Device list cache: revalidated in the background at least this often
+#define DEVICE_CACHE_TTL_MS 60000
+
+// Volume changes are coalesced: at most one PUT per interval, always the latest value
+#define VOLUME_PUT_INTERVAL_MS 500
+#define VOLUME_PUT_RETRIES 2 // A failed PUT is retried this often (one interval apart) unless a newer value arrives
+
 struct SpotifyTrack
 {
     String name;
@@ -30,6 +42,7 @@ struct SpotifyTrack
     bool shuffleState;
     String repeatState;  // "off", "track", "context"
     unsigned long timestamp;
+    int64_t sampledAtUs; // esp_timer time progress_ms was valid (request midpoint), 0 = unknown
     String deviceName;
     int deviceVolume;
     bool deviceIsActive;
@@ -49,7 +62,8 @@ class SpotifyManager
 {
 public:
     SpotifyManager();
-    bool init();
+    bool init();         // Locks and background worker, no network access
+    bool authenticate(); // First access token, blocks on TLS: call from a boot task
     bool refreshAccessToken();
     bool getCurrentTrack(SpotifyTrack &track);
     bool getPlaybackState(SpotifyTrack &track);
@@ -58,9 +72,17 @@ public:
     bool next();
     bool previous();
     bool setVolume(int volume); // 0-100
-    bool getDevices(SpotifyDevice devices[], int maxDevices, int &deviceCount);
+    bool getDevices(std::vector<SpotifyDevice> &devices);
     bool transferPlayback(const String &deviceId);
-    String getAccessToken() { return accessToken; }
+    String getAccessToken();
+
+    // Device cache: returns the last known list instantly, refreshed in background
+    uint32_t getCachedDevices(std::vector<SpotifyDevice> &devices); // Returns cache generation
+    uint32_t getDeviceCacheGeneration();
+    void requestDeviceRefresh();
+
+    // Non-blocking volume change, sent by the background worker (rate limited)
+    void requestVolume(int volume); // 0-100
 
 private:
     String accessToken;
@@ -68,8 +90,32 @@ private:
     unsigned long tokenExpiry;
     WiFiClientSecure client;
     HTTPClient http;
+    SemaphoreHandle_t tokenMutex;
+
+    // Device cache shared with the background worker
+    std::vector<SpotifyDevice> cachedDevices;
+    volatile uint32_t deviceCacheGeneration;
+    volatile unsigned long deviceCacheUpdatedAt;
+    SemaphoreHandle_t cacheMutex;
+    TaskHandle_t workerTask;
+    std::atomic<bool> deviceRefreshRequested;
+    std::atomic<int> pendingVolume; // -1 when nothing is waiting
+    unsigned long lastVolumePutAt;
+    uint32_t volumeRequests;
+    uint32_t volumePuts;
+    uint8_t volumeRetries; // Retries spent on the value being sent
+    String lastPlaybackDevice;
+    bool lastPlaybackDeviceActive;
 
+    bool ensureAccessToken();
+    bool requestAccessToken();
     bool makeSpotifyRequest(const String &endpoint, const String &method, const String &body, String &response);
+    bool makeSpotifyRequest(HTTPClient &http, const String &endpoint, const String &method, const String &body, String &response);
+    bool fetchDevices(HTTPClient &http, std::vector<SpotifyDevice> &devices);
+    void publishDevices(const std::vector<SpotifyDevice> &devices);
+    void sendPendingVolume(HTTPClient &http);
+    void startBackgroundWorker();
+    static void workerTaskFunction(void *parameter);
     bool parseCurrentTrack(const String &response, SpotifyTrack &track);
     bool parsePlaybackState(const String &response, SpotifyTrack &track);
     String base64Encode(const String &str);
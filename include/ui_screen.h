@@ -0,0 +1,12 @@
+#ifndef UI_SCREEN_H
+#define UI_SCREEN_H
+
+// Screen management (no LVGL dependency, shared with the gesture bindings)
+enum UIScreen
+{
+    SCREEN_MAIN = 0,
+    SCREEN_DEVICES = 1,
+    SCREEN_SPECTRUM = 2
+};
+
+#endif // UI_SCREEN_H
@@ -4,6 +4,61 @@
 #include <WiFi.h>
 #include <esp_smartconfig.h>
 #include <Preferences.h>
+#include <atomic>
+
+// Credential store: several networks with join history, ranked by each scan
+#define WIFI_MAX_NETWORKS 6
+#define WIFI_SCAN_TIMEOUT_MS 10000
+#define WIFI_HISTORY_WEIGHT_DB 20  // Score of a network that always joins vs. one that never does
+#define WIFI_LAST_USED_BONUS_DB 5  // Tie-break towards the network joined last
+#define WIFI_HISTORY_DECAY_AT 200  // Halve the counters so old history fades
+
+// Fast reconnect: directed, channel-locked join reusing the last DHCP lease.
+// The lease is only reused up to its renewal time (T1, half the lease), the
+// point where a DHCP client would renew it; a connection that outlives T1
+// switches to DHCP in place. Lease age is measured on the system clock,
+// which keeps running across software resets and deep sleep but restarts at
+// power-on, so after a power-on the first join always runs DHCP.
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000 // A good fast join takes a few hundred ms
+#define WIFI_CONNECT_HIST_BUCKETS 8       // <250 <500 <1k <2k <4k <8k <16k >=16k ms
+
+// Last good association, persisted in NVS
+struct WiFiFastConnectCache
+{
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    int64_t leaseObtainedUs; // System time the DHCP server granted the lease
+    uint32_t leaseSeconds;   // Granted lease time, 0 = unknown (never reused)
+};
+
+// One known network, persisted in NVS as part of the store
+struct WiFiNetworkRecord
+{
+    char ssid[33];
+    char password[65];
+    uint16_t successes;
+    uint16_t failures;
+    uint32_t lastSuccess; // Store connect sequence of the last join, 0 = never
+};
+
+struct WiFiCredentialStore
+{
+    uint8_t count;
+    uint32_t connectSequence; // Bumped on every successful join
+    WiFiNetworkRecord networks[WIFI_MAX_NETWORKS];
+};
+
+// Time from the first stored-credential attempt to GOT_IP, persisted across boots
+struct WiFiConnectHistogram
+{
+    uint16_t fast[WIFI_CONNECT_HIST_BUCKETS]; // Connected on the directed attempt
+    uint16_t full[WIFI_CONNECT_HIST_BUCKETS]; // Needed a scan (and DHCP)
+};
 
 class WiFiManager
 {
@@ -16,41 +71,110 @@ public:
         LED_ERROR
     };
 
+    // Connection state machine, advanced by update() from WiFi events
+    enum ConnectionState {
+        STATE_IDLE,
+        STATE_SCANNING,    // One scan to rank the known networks in range
+        STATE_CONNECTING,  // Association/DHCP in progress
+        STATE_CONNECTED,
+        STATE_SMARTCONFIG, // Waiting for ESP Touch credentials
+        STATE_RETRY_WAIT   // Backing off before scanning again
+    };
+
     WiFiManager();
-    bool connect();
+    bool connect(); // Starts connecting in the background, never blocks
     bool startSmartConfig();
     void stopSmartConfig();
     bool isSmartConfigActive();
     String getSmartConfigStatus();
     bool hasStoredCredentials();
     void clearStoredCredentials();
+    bool addNetwork(const String &ssid, const String &password);
+    bool forgetNetwork(const String &ssid);
+    uint8_t getNetworkCount();
     void disconnect();
-    void update();
+    void update(); // Never blocks: consumes WiFi events and timeouts
     bool isConnected();
+    ConnectionState getState();
+    String getShortStatus(); // Fits next to the status bar icon ("" when connected)
+    void printConnectStats();
     int getRSSI();
     String getIP();
     String getMACAddress();
     String getSSID();
-    
-    // New methods
-    bool connectWithFallbackCredentials();
+
     void setLEDColor(int r, int g, int b);
     void setLEDStatus(LEDStatus status);
 
 private:
+    // Where the credentials of the current attempt came from
+    enum CredentialSource {
+        SOURCE_STORED,
+        SOURCE_SMARTCONFIG
+    };
+
+    // A known network seen by the last scan (best AP of that SSID)
+    struct Candidate
+    {
+        uint8_t network; // Index into the store
+        int8_t rssi;
+        uint8_t channel;
+        uint8_t bssid[6];
+        int score;
+    };
+
     bool _connected;
     bool _smartConfigActive;
-    unsigned long _lastReconnectAttempt;
+    bool _eventsRegistered;
+    bool _settingsLoaded;
+    bool _fastAttempt; // Current attempt is the directed join from the cache
+    bool _staticLease; // Current attempt/connection runs on the cached lease, no DHCP client
+    WiFiCredentialStore _store;
+    Candidate _candidates[WIFI_MAX_NETWORKS];
+    uint8_t _candidateCount;
+    uint8_t _nextCandidate;
+    int _attemptNetwork; // Store index of the current attempt, -1 for SmartConfig
+    bool _fastCacheValid;
+    WiFiFastConnectCache _fastCache;
+    WiFiConnectHistogram _connectHist;
+    unsigned long _connectChainStart; // First stored-credential attempt of this (re)connect
+    ConnectionState _state;
+    CredentialSource _source;
+    unsigned long _stateStartTime;
     unsigned long _smartConfigStartTime;
     String _smartConfigStatus;
+    String _attemptSSID;
     Preferences _preferences;
-    
-    static const unsigned long _reconnectInterval = 30000; // 30 seconds
+
+    // Set by the WiFi event task, consumed by update()
+    std::atomic<bool> _eventGotIP;
+    std::atomic<bool> _eventDisconnected;
+    std::atomic<uint8_t> _disconnectReason;
+
     static const unsigned long _smartConfigTimeout = 20000; // Changed to 20 seconds
-    
-    bool connectWithStoredCredentials();
-    void saveCredentials(String ssid, String password);
-    bool loadCredentials(String &ssid, String &password);
+    static const unsigned long _retryDelay = 1000;          // Before scanning again
+
+    void loadSettings();
+    void registerEvents();
+    void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info);
+    void setState(ConnectionState state);
+    void startConnecting();
+    bool beginFastAttempt();
+    void startScan();
+    void rankCandidates(int16_t found);
+    void beginNextCandidate();
+    void joinNetwork(int network, uint8_t channel, const uint8_t *bssid, bool staticLease);
+    void attemptFailed(const char *why);
+    void onConnected();
+    int findNetwork(const char *ssid);
+    void recordResult(int network, bool success);
+    void saveStore();
+    void loadFastConnectCache();
+    void saveFastConnectCache();
+    void clearFastConnectCache();
+    int32_t leaseSecondsToRenewal(); // Negative once the cached lease is due for renewal (or unknown)
+    void renewLease();
+    void recordConnectTime(unsigned long ms, bool fast);
 };
 
-#endif
\ No newline at end of file
+#endif
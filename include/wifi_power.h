@@ -0,0 +1,85 @@
+#ifndef WIFI_POWER_H
+#define WIFI_POWER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+// Doze: modem sleep that only wakes for every Nth beacon, used between polls
+#define WIFI_POWER_LISTEN_INTERVAL 6        // Beacons per wake in doze (~600 ms at 100 TU)
+#define WIFI_POWER_PREWAKE_MS 150           // Leave doze this long before scheduled traffic
+#define WIFI_POWER_TAIL_MS 500              // Stay awake after traffic for follow-up requests
+#define WIFI_POWER_INPUT_HOLD_MS 3000       // Stay awake after button input, commands follow
+#define WIFI_POWER_STATS_INTERVAL_MS 60000
+
+enum WiFiWakeReason : uint8_t
+{
+    WIFI_WAKE_SCHEDULED, // Ahead of a poll
+    WIFI_WAKE_INPUT,     // Button press
+    WIFI_WAKE_TRAFFIC,   // Request outside the schedule
+    WIFI_WAKE_REASONS
+};
+
+// Radio-on proxy over the last stats interval
+struct WiFiPowerStats
+{
+    uint32_t awakeMs; // No power save (includes time not connected)
+    uint32_t dozeMs;  // Modem sleep with the long listen interval
+    uint32_t wakes[WIFI_WAKE_REASONS];
+};
+
+// Platform side of the policy, injected so it runs in virtual time on the host
+struct WiFiPowerHooks
+{
+    uint32_t (*clockMs)();
+    void (*setModemSleep)(bool doze);              // Max modem sleep, or no power save
+    void (*logStats)(const WiFiPowerStats &stats); // Once per stats interval, may be null
+};
+
+// Switches the station between no power save (awake) and modem sleep (doze).
+// Traffic, input and the poll schedule keep it awake; the main loop decides
+// when to doze, any task can wake it.
+class WiFiPowerPolicy
+{
+public:
+    WiFiPowerPolicy();
+
+    void begin(const WiFiPowerHooks &hooks);      // Until then the radio mode is left alone
+    void update(bool connected);                  // Main loop only
+    void scheduleActivity(uint32_t atMs);         // Next known traffic (e.g. poll), main loop only
+    void wake(WiFiWakeReason reason);             // Any task
+    void beginActivity();                         // Any task, pair with endActivity()
+    void endActivity();
+    bool isDozing() const { return dozing; }
+    WiFiPowerStats getStats() const { return lastStats; }
+
+private:
+    WiFiPowerHooks hooks;
+    std::atomic<bool> started;
+    std::mutex lock;
+    volatile bool dozing;
+    std::atomic<int> activeRequests;
+    uint32_t awakeUntil;  // Under lock
+    uint32_t nextActivityAt;
+    bool activityScheduled;
+    bool wasConnected;
+    uint32_t lastAccountMs;
+    uint32_t statsStartMs;
+    WiFiPowerStats stats;
+    WiFiPowerStats lastStats;
+
+    void setAwake(WiFiWakeReason reason, uint32_t holdMs);
+    void account(uint32_t now);
+};
+
+// Keeps the radio awake for the lifetime of a request
+class WiFiActivity
+{
+public:
+    WiFiActivity();
+    ~WiFiActivity();
+};
+
+extern WiFiPowerPolicy wifiPower;
+
+#endif
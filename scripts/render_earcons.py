@@ -0,0 +1,204 @@
+"""Render the UI earcons to IMA-ADPCM at build time.
+
+The note tables in src/audio_earcons.cpp stay the single source of truth:
+this script parses them, renders each earcon with the same envelope and
+waveforms as AudioSynth, encodes it to 4-bit IMA-ADPCM and writes
+earcon_bank.h into the build directory. The firmware streams the blobs
+straight out of memory-mapped flash.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:...), or
+standalone: python3 scripts/render_earcons.py <output_dir>
+"""
+
+import math
+import os
+import re
+import sys
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+EARCONS_SRC = "src/audio_earcons.cpp"
+SYNTH_H = "include/audio_synth.h"
+MANAGER_H = "include/audio_manager.h"
+
+# Everything the bank depends on: it is only re-rendered when one of these changes
+SOURCES = [EARCONS_SRC, SYNTH_H, MANAGER_H, "scripts/render_earcons.py"]
+
+
+def read(project_dir, path):
+    with open(os.path.join(project_dir, path), encoding="utf-8") as f:
+        return f.read()
+
+
+def parse_sources(project_dir):
+    earcons_src = read(project_dir, EARCONS_SRC)
+    synth_h = read(project_dir, SYNTH_H)
+    manager_h = read(project_dir, MANAGER_H)
+
+    sample_rate = int(re.search(r"#define AUDIO_SAMPLE_RATE (\d+)", manager_h).group(1))
+    envelope = [int(v) for v in re.search(
+        r"#define SYNTH_DEFAULT_ENVELOPE \{([^}]*)\}", synth_h).group(1).split(",")]
+
+    tables = {}
+    for name, body in re.findall(r"static const SynthNote (\w+)\[\] = \{(.*?)\};", earcons_src, re.S):
+        notes = []
+        for start, freq, dur, level, wave in re.findall(
+                r"\{\s*(\d+),\s*(\d+),\s*(\d+),\s*(\d+),\s*(WAVE_\w+)\s*\}", body):
+            notes.append((int(start), int(freq), int(dur), int(level), wave))
+        tables[name] = notes
+
+    # Bank order follows the EARCON(...) table, which is indexed by the Earcon enum
+    earcons = re.findall(r'EARCON\("(\w+)",\s*(\w+)\)', earcons_src)
+    return sample_rate, envelope, [(name, tables[table]) for name, table in earcons]
+
+
+def render(notes, sample_rate, envelope):
+    """Float model of AudioSynth: linear ADSR, gate from note start, then release."""
+    attack_ms, decay_ms, sustain_pct, release_ms = envelope
+    frames = lambda ms: max(int(ms * sample_rate / 1000), 1)
+    end = max(frames(s) + frames(d) + frames(release_ms) for s, _, d, _, _ in notes)
+    mix = [0.0] * end
+
+    for start_ms, freq, dur_ms, level, wave in notes:
+        start, gate = frames(start_ms), int(dur_ms * sample_rate / 1000)
+        attack, decay, release = frames(attack_ms), frames(decay_ms), frames(release_ms)
+        sustain = sustain_pct / 100.0
+        amplitude = (32767.0 if wave == "WAVE_SINE" else 16384.0) * min(level, 100) / 100.0
+        env, released_from = 0.0, None
+
+        for i in range(gate + release):
+            if i < gate:
+                if i < attack:
+                    env = (i + 1) / attack
+                elif i < attack + decay:
+                    env = 1.0 - (1.0 - sustain) * (i - attack + 1) / decay
+                else:
+                    env = sustain
+            else:
+                if released_from is None:
+                    released_from = env
+                env = max(released_from * (1.0 - (i - gate + 1) / release), 0.0)
+
+            phase = (freq * i / sample_rate) % 1.0
+            if wave == "WAVE_SINE":
+                osc = math.sin(2.0 * math.pi * phase)
+            else:
+                osc = 1.0 if phase < 0.5 else -1.0
+            mix[start + i] += amplitude * env * osc
+
+    return [max(-32768, min(32767, int(round(s)))) for s in mix]
+
+
+def adpcm_encode(samples):
+    predictor, index = 0, 0
+    out = bytearray()
+    nibbles = []
+
+    for sample in samples:
+        step = STEP_TABLE[index]
+        diff = sample - predictor
+        nibble = 0
+        if diff < 0:
+            nibble = 8
+            diff = -diff
+
+        # Same quantization as the decoder's reconstruction
+        delta = step >> 3
+        if diff >= step:
+            nibble |= 4
+            diff -= step
+            delta += step
+        if diff >= step >> 1:
+            nibble |= 2
+            diff -= step >> 1
+            delta += step >> 1
+        if diff >= step >> 2:
+            nibble |= 1
+            delta += step >> 2
+
+        predictor = predictor - delta if nibble & 8 else predictor + delta
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + INDEX_TABLE[nibble]))
+        nibbles.append(nibble)
+
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    for i in range(0, len(nibbles), 2):
+        out.append(nibbles[i] | (nibbles[i + 1] << 4))
+    return bytes(out)
+
+
+def up_to_date(project_dir, path):
+    if not os.path.exists(path):
+        return False
+    built = os.path.getmtime(path)
+    return all(os.path.getmtime(os.path.join(project_dir, source)) <= built for source in SOURCES)
+
+
+def generate(project_dir, out_dir):
+    path = os.path.join(out_dir, "earcon_bank.h")
+    if up_to_date(project_dir, path):
+        return
+
+    sample_rate, envelope, earcons = parse_sources(project_dir)
+
+    lines = [
+        "// Generated by scripts/render_earcons.py from src/audio_earcons.cpp - do not edit",
+        "#ifndef EARCON_BANK_H",
+        "#define EARCON_BANK_H",
+        "",
+        "#define EARCON_BANK_SAMPLE_RATE %d" % sample_rate,
+        "#define EARCON_BANK_COUNT %d" % len(earcons),
+        "",
+    ]
+    total = 0
+    clips = []
+    for name, notes in earcons:
+        samples = render(notes, sample_rate, envelope)
+        encoded = adpcm_encode(samples)
+        clips.append((name, len(samples)))
+        total += len(encoded)
+        lines.append("static const uint8_t earcon_%s_adpcm[] = {" % name)
+        for i in range(0, len(encoded), 24):
+            lines.append("    " + ", ".join("0x%02x" % b for b in encoded[i:i + 24]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("static const EarconClip earconBank[EARCON_BANK_COUNT] = {")
+    for name, sample_count in clips:
+        lines.append("    {earcon_%s_adpcm, %d}," % (name, sample_count))
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // EARCON_BANK_H")
+    lines.append("")
+
+    os.makedirs(out_dir, exist_ok=True)
+    content = "\n".join(lines)
+    if not os.path.exists(path) or open(path, encoding="utf-8").read() != content:
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(content)
+        print("Earcon bank: %d earcons, %d bytes of ADPCM -> %s" % (len(earcons), total, path))
+    else:
+        # Same bank (e.g. an unrelated edit to audio_manager.h): mark it current
+        # without touching its contents, so nothing that includes it rebuilds
+        os.utime(path)
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+    project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+    generated_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+    generate(project_dir, generated_dir)
+    env.Append(CPPPATH=[generated_dir])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                 sys.argv[1] if len(sys.argv) > 1 else "generated")
@@ -0,0 +1,162 @@
+#include "audio_earcons.h"
+#include "audio_manager.h"
+
+// Generated into the build directory by the pre-build script; without it
+// (e.g. a build outside PlatformIO) earcons fall back to the synth
+#if __has_include("earcon_bank.h")
+#include "earcon_bank.h"
+#define HAVE_EARCON_BANK 1
+static_assert(EARCON_BANK_COUNT == EARCON_COUNT, "Earcon bank out of date with the Earcon enum");
+static_assert(EARCON_BANK_SAMPLE_RATE == OUTPUT_SAMPLE_RATE, "Earcon bank rendered at the wrong sample rate");
+#else
+#define HAVE_EARCON_BANK 0
+#endif
+
+// Note tables: {startMs, frequency, durationMs, level, waveform}
+static const SynthNote startupNotes[] = {
+    {0, 800, 200, 100, WAVE_SINE},
+    {300, 1000, 200, 100, WAVE_SINE},
+    {600, 1200, 200, 100, WAVE_SINE}};
+
+static const SynthNote readyNotes[] = {
+    {0, 1000, 100, 100, WAVE_SINE},
+    {150, 1200, 100, 100, WAVE_SINE},
+    {300, 1500, 200, 100, WAVE_SINE}};
+
+static const SynthNote screenEnterNotes[] = {
+    {0, 1000, 100, 100, WAVE_SINE},
+    {150, 1200, 100, 100, WAVE_SINE},
+    {300, 1400, 100, 100, WAVE_SINE}};
+
+static const SynthNote screenExitNotes[] = {
+    {0, 800, 100, 100, WAVE_SINE},
+    {150, 600, 100, 100, WAVE_SINE},
+    {300, 400, 100, 100, WAVE_SINE}};
+
+static const SynthNote playPauseNotes[] = {
+    {0, 800, 150, 100, WAVE_SINE}};
+
+static const SynthNote nextNotes[] = {
+    {0, 1000, 100, 100, WAVE_SINE},
+    {150, 1200, 100, 100, WAVE_SINE}};
+
+static const SynthNote previousNotes[] = {
+    {0, 600, 100, 100, WAVE_SINE},
+    {150, 500, 100, 100, WAVE_SINE}};
+
+static const SynthNote navUpNotes[] = {
+    {0, 400, 80, 100, WAVE_SINE}};
+
+static const SynthNote navDownNotes[] = {
+    {0, 800, 80, 100, WAVE_SINE}};
+
+static const SynthNote selectNotes[] = {
+    {0, 1000, 150, 100, WAVE_SINE},
+    {250, 1200, 150, 100, WAVE_SINE}};
+
+static const SynthNote confirmNotes[] = {
+    {0, 1500, 200, 100, WAVE_SINE}};
+
+static const SynthNote alreadyActiveNotes[] = {
+    {0, 800, 200, 100, WAVE_SINE}};
+
+static const SynthNote rejectNotes[] = {
+    {0, 400, 200, 100, WAVE_SINE}};
+
+static const SynthNote errorNotes[] = {
+    {0, 400, 200, 80, WAVE_SQUARE},
+    {300, 400, 200, 80, WAVE_SQUARE},
+    {600, 400, 200, 80, WAVE_SQUARE}};
+
+#define EARCON(name, notes) {name, notes, sizeof(notes) / sizeof(notes[0])}
+
+static const EarconDefinition earcons[EARCON_COUNT] = {
+    EARCON("startup", startupNotes),
+    EARCON("ready", readyNotes),
+    EARCON("screen_enter", screenEnterNotes),
+    EARCON("screen_exit", screenExitNotes),
+    EARCON("play_pause", playPauseNotes),
+    EARCON("next", nextNotes),
+    EARCON("previous", previousNotes),
+    EARCON("nav_up", navUpNotes),
+    EARCON("nav_down", navDownNotes),
+    EARCON("select", selectNotes),
+    EARCON("confirm", confirmNotes),
+    EARCON("already_active", alreadyActiveNotes),
+    EARCON("reject", rejectNotes),
+    EARCON("error", errorNotes)};
+
+const EarconDefinition &audio_earcon(Earcon earcon)
+{
+    return earcons[earcon < EARCON_COUNT ? earcon : EARCON_REJECT];
+}
+
+bool audio_earcon_bank_available()
+{
+    return HAVE_EARCON_BANK;
+}
+
+EarconStream::EarconStream()
+{
+    data = nullptr;
+    position = 0;
+    remaining = 0;
+    ima_adpcm_reset(state);
+}
+
+bool EarconStream::start(Earcon earcon)
+{
+#if HAVE_EARCON_BANK
+    if (earcon >= EARCON_COUNT)
+    {
+        return false;
+    }
+
+    // Restart from the clip start; a new earcon replaces the one playing
+    data = earconBank[earcon].adpcm;
+    position = 0;
+    remaining = earconBank[earcon].sampleCount;
+    ima_adpcm_reset(state);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EarconStream::stop()
+{
+    remaining = 0;
+}
+
+inline int16_t EarconStream::next()
+{
+    uint8_t byte = data[position >> 1]; // Read through the flash cache, no copy
+    uint8_t nibble = (position & 1) ? (byte >> 4) : (byte & 0x0F);
+    position++;
+    remaining--;
+    return ima_adpcm_decode_nibble(state, nibble);
+}
+
+void EarconStream::renderSlots(int32_t *slots, int frames, int32_t gain)
+{
+    int count = min((uint32_t)frames, remaining);
+    int i = 0;
+
+    for (; i < count; i++)
+    {
+        slots[i] = ((next() * gain) >> 15) << 16;
+    }
+    for (; i < frames; i++)
+    {
+        slots[i] = 0;
+    }
+}
+
+void EarconStream::mix(int32_t *accumulator, int frames)
+{
+    int count = min((uint32_t)frames, remaining);
+    for (int i = 0; i < count; i++)
+    {
+        accumulator[i] += next();
+    }
+}
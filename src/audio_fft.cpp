@@ -0,0 +1,388 @@
+#include "audio_fft.h"
+#include <math.h>
+#include <algorithm>
+
+#ifdef AUDIO_FFT_SELF_TEST
+#include <Arduino.h>
+#include <esp_timer.h>
+#endif
+
+// ESP32-S3 vector FFT from esp-dsp when the SDK ships it, scalar Q15 otherwise
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define AUDIO_FFT_HAS_SIMD 1
+#else
+#define AUDIO_FFT_HAS_SIMD 0
+#endif
+
+#define FFT_HALF (AUDIO_FFT_SIZE / 2) // Complex FFT length M
+
+// Precomputed tables
+static int16_t hannWindow[AUDIO_FFT_SIZE];  // Q15, peak 0.5 to leave butterfly headroom
+static int16_t twiddle[3 * FFT_HALF / 2];   // 3M/4 complex (cos, sin) of 2*pi*k/M, radix-4 needs W^3k
+static int16_t splitTwiddle[AUDIO_FFT_SIZE]; // M complex (cos, sin) of 2*pi*k/N
+static uint8_t bitReverse[FFT_HALF];
+
+// Octave band bin ranges [start, end)
+static uint16_t bandStart[AUDIO_FFT_MAX_BANDS];
+static uint16_t bandEnd[AUDIO_FFT_MAX_BANDS];
+static int bandCount = 0;
+
+static bool initialized = false;
+static bool useSimd = false;
+
+static inline int16_t to_q15(double value)
+{
+    long v = lround(value * 32768.0);
+    if (v > 32767) v = 32767;
+    if (v < -32768) v = -32768;
+    return (int16_t)v;
+}
+
+// Window and pack the real input as an M-point complex sequence
+static void window_and_pack(const int16_t *samples, int16_t *work)
+{
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        work[n] = (int16_t)(((int32_t)samples[n] * hannWindow[n] + 0x4000) >> 15);
+    }
+}
+
+// Complex Q15 multiply by the twiddle e^(-j*2*pi*index/M)
+static inline void twiddle_mul(int32_t &re, int32_t &im, int index)
+{
+    int32_t c = twiddle[2 * index];
+    int32_t s = twiddle[2 * index + 1];
+    int32_t r = (re * c + im * s + 0x4000) >> 15;
+    im = (im * c - re * s + 0x4000) >> 15;
+    re = r;
+}
+
+// In-place mixed radix DIT FFT of M complex Q15 values: one radix-2 stage when
+// log2(M) is odd, radix-4 for the rest. Scaled by 1/2 per radix-2 stage, i.e.
+// 1/M overall. A radix-4 pass does the work of two radix-2 stages with three
+// twiddle multiplies instead of four and one trip through memory instead of two.
+static void fft_complex_scalar(int16_t *work)
+{
+    for (int i = 0; i < FFT_HALF; i++)
+    {
+        int r = bitReverse[i];
+        if (i < r)
+        {
+            int16_t tr = work[2 * i], ti = work[2 * i + 1];
+            work[2 * i] = work[2 * r];
+            work[2 * i + 1] = work[2 * r + 1];
+            work[2 * r] = tr;
+            work[2 * r + 1] = ti;
+        }
+    }
+
+    int quarter = 1; // Length of the sub-DFTs each radix-4 butterfly combines
+    if (__builtin_ctz(FFT_HALF) & 1)
+    {
+        for (int a = 0; a < 2 * FFT_HALF; a += 4)
+        {
+            int32_t ar = work[a], ai = work[a + 1];
+            int32_t br = work[a + 2], bi = work[a + 3];
+            work[a] = (int16_t)((ar + br) >> 1);
+            work[a + 1] = (int16_t)((ai + bi) >> 1);
+            work[a + 2] = (int16_t)((ar - br) >> 1);
+            work[a + 3] = (int16_t)((ai - bi) >> 1);
+        }
+        quarter = 2;
+    }
+
+    // After radix-2 bit reversal the four quarters of a group hold the DFTs of
+    // x[4n], x[4n+2], x[4n+1], x[4n+3]
+    for (; quarter < FFT_HALF; quarter <<= 2)
+    {
+        int size = quarter << 2;
+        int step = FFT_HALF / size;
+
+        for (int start = 0; start < FFT_HALF; start += size)
+        {
+            for (int k = 0; k < quarter; k++)
+            {
+                int p0 = 2 * (start + k);
+                int p1 = p0 + 2 * quarter;
+                int p2 = p1 + 2 * quarter;
+                int p3 = p2 + 2 * quarter;
+
+                int32_t t0r = work[p0], t0i = work[p0 + 1];
+                int32_t t1r = work[p2], t1i = work[p2 + 1]; // x[4n+1] * W^k
+                int32_t t2r = work[p1], t2i = work[p1 + 1]; // x[4n+2] * W^2k
+                int32_t t3r = work[p3], t3i = work[p3 + 1]; // x[4n+3] * W^3k
+                if (k != 0)
+                {
+                    twiddle_mul(t1r, t1i, k * step);
+                    twiddle_mul(t2r, t2i, 2 * k * step);
+                    twiddle_mul(t3r, t3i, 3 * k * step);
+                }
+
+                // 4-point DFT, W^(size/4) = -j
+                int32_t s02r = t0r + t2r, s02i = t0i + t2i;
+                int32_t d02r = t0r - t2r, d02i = t0i - t2i;
+                int32_t s13r = t1r + t3r, s13i = t1i + t3i;
+                int32_t d13r = t1r - t3r, d13i = t1i - t3i;
+
+                work[p0] = (int16_t)((s02r + s13r + 2) >> 2);
+                work[p0 + 1] = (int16_t)((s02i + s13i + 2) >> 2);
+                work[p1] = (int16_t)((d02r + d13i + 2) >> 2); // - j * d13
+                work[p1 + 1] = (int16_t)((d02i - d13r + 2) >> 2);
+                work[p2] = (int16_t)((s02r - s13r + 2) >> 2);
+                work[p2 + 1] = (int16_t)((s02i - s13i + 2) >> 2);
+                work[p3] = (int16_t)((d02r - d13i + 2) >> 2); // + j * d13
+                work[p3 + 1] = (int16_t)((d02i + d13r + 2) >> 2);
+            }
+        }
+    }
+}
+
+#if AUDIO_FFT_HAS_SIMD
+static void fft_complex_simd(int16_t *work)
+{
+    dsps_fft2r_sc16(work, FFT_HALF);
+    dsps_bit_rev_sc16_ansi(work, FFT_HALF);
+}
+#endif
+
+// Split the M-point complex result into the N-point real spectrum:
+// X[k] = Fe[k] + W_N^k * Fo[k]
+static void split_real_spectrum(const int16_t *work, int32_t *spectrum)
+{
+    // DC and Nyquist are purely real
+    int32_t z0r = work[0], z0i = work[1];
+    spectrum[0] = z0r + z0i;
+    spectrum[1] = 0;
+    spectrum[2 * FFT_HALF] = z0r - z0i;
+    spectrum[2 * FFT_HALF + 1] = 0;
+
+    for (int k = 1; k < FFT_HALF; k++)
+    {
+        int m = FFT_HALF - k;
+        int32_t zr = work[2 * k], zi = work[2 * k + 1];
+        int32_t cr = work[2 * m], ci = -work[2 * m + 1]; // conj(Z[M-k])
+
+        // Even part (Z + conj) / 2, odd part -j * (Z - conj) / 2
+        int32_t er = (zr + cr) >> 1;
+        int32_t ei = (zi + ci) >> 1;
+        int32_t orr = (zi - ci) >> 1;
+        int32_t oi = -((zr - cr) >> 1);
+
+        int32_t c = splitTwiddle[2 * k];
+        int32_t s = splitTwiddle[2 * k + 1];
+        spectrum[2 * k] = er + ((orr * c + oi * s + 0x4000) >> 15);
+        spectrum[2 * k + 1] = ei + ((oi * c - orr * s + 0x4000) >> 15);
+    }
+}
+
+// Reentrant: the work buffer lives on the caller's stack so several tasks can
+// run spectra concurrently. z[n] = x[2n] + j*x[2n+1]
+static void run_fft(const int16_t *samples, int32_t *spectrum, bool simd)
+{
+    int16_t work[AUDIO_FFT_SIZE] __attribute__((aligned(16)));
+
+    window_and_pack(samples, work);
+#if AUDIO_FFT_HAS_SIMD
+    if (simd)
+    {
+        fft_complex_simd(work);
+    }
+    else
+#endif
+    {
+        (void)simd;
+        fft_complex_scalar(work);
+    }
+    split_real_spectrum(work, spectrum);
+}
+
+bool audio_fft_init(uint32_t sampleRate, int numBands)
+{
+    // Periodic Hann window, scaled to 0.5 peak
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        hannWindow[n] = to_q15(0.25 * (1.0 - cos(2.0 * M_PI * n / AUDIO_FFT_SIZE)));
+    }
+
+    for (int k = 0; k < 3 * FFT_HALF / 4; k++)
+    {
+        twiddle[2 * k] = to_q15(cos(2.0 * M_PI * k / FFT_HALF));
+        twiddle[2 * k + 1] = to_q15(sin(2.0 * M_PI * k / FFT_HALF));
+    }
+
+    for (int k = 0; k < FFT_HALF; k++)
+    {
+        splitTwiddle[2 * k] = to_q15(cos(2.0 * M_PI * k / AUDIO_FFT_SIZE));
+        splitTwiddle[2 * k + 1] = to_q15(sin(2.0 * M_PI * k / AUDIO_FFT_SIZE));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < FFT_HALF)
+        bits++;
+    for (int i = 0; i < FFT_HALF; i++)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; b++)
+        {
+            if (i & (1 << b))
+                r |= 1 << (bits - 1 - b);
+        }
+        bitReverse[i] = r;
+    }
+
+    // Octave bands centered on 1 kHz * 2^(b - 4): 62.5 Hz, 125 Hz ... 8 kHz for 8 bands
+    bandCount = std::min(numBands, AUDIO_FFT_MAX_BANDS);
+    float binHz = (float)sampleRate / AUDIO_FFT_SIZE;
+    int nextStart = 1; // Skip DC
+    for (int b = 0; b < bandCount; b++)
+    {
+        float center = 1000.0f * powf(2.0f, (float)(b - 4));
+        int end = (int)floorf(center * 1.41421356f / binHz) + 1;
+        end = std::min(std::max(end, nextStart + 1), AUDIO_FFT_BINS);
+        bandStart[b] = std::min(nextStart, AUDIO_FFT_BINS - 1);
+        bandEnd[b] = end;
+        nextStart = end;
+    }
+
+#if AUDIO_FFT_HAS_SIMD
+    useSimd = dsps_fft2r_init_sc16(NULL, CONFIG_DSP_MAX_FFT_SIZE) == ESP_OK;
+#endif
+
+    initialized = true;
+    return true;
+}
+
+bool audio_fft_uses_simd()
+{
+    return useSimd;
+}
+
+void audio_fft_real(const int16_t *samples, int32_t *spectrum)
+{
+    run_fft(samples, spectrum, useSimd);
+}
+
+void audio_fft_power(const int16_t *samples, uint32_t *power)
+{
+    int32_t spectrum[AUDIO_FFT_BINS * 2];
+    run_fft(samples, spectrum, useSimd);
+
+    for (int k = 0; k < AUDIO_FFT_BINS; k++)
+    {
+        int64_t re = spectrum[2 * k];
+        int64_t im = spectrum[2 * k + 1];
+        uint64_t p = re * re + im * im;
+        power[k] = p > UINT32_MAX ? UINT32_MAX : (uint32_t)p;
+    }
+}
+
+void audio_fft_bands(const uint32_t *power, float *bands, int numBands)
+{
+    for (int b = 0; b < numBands; b++)
+    {
+        if (b >= bandCount)
+        {
+            bands[b] = 0.0f;
+            continue;
+        }
+
+        uint64_t sum = 0;
+        for (int k = bandStart[b]; k < bandEnd[b]; k++)
+        {
+            sum += power[k];
+        }
+
+        float db = 10.0f * log10f((float)sum + 1.0f);
+        float level = (db - AUDIO_FFT_BAND_FLOOR_DB) / AUDIO_FFT_BAND_RANGE_DB;
+        bands[b] = std::min(std::max(level, 0.0f), 1.0f);
+    }
+}
+
+#ifdef AUDIO_FFT_SELF_TEST
+// Compare a fixed-point path against a double precision DFT of the same windowed input
+static double measure_snr_db(const int16_t *input, bool simd)
+{
+    static int32_t spectrum[AUDIO_FFT_BINS * 2];
+    run_fft(input, spectrum, simd);
+
+    // Trig and windowed input tables keep the reference DFT cheap on soft double
+    static double cosTable[AUDIO_FFT_SIZE];
+    static double windowed[AUDIO_FFT_SIZE];
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        cosTable[n] = cos(2.0 * M_PI * n / AUDIO_FFT_SIZE);
+        windowed[n] = input[n] * 0.25 * (1.0 - cosTable[n]);
+    }
+
+    double signal = 0.0, noise = 0.0;
+    for (int k = 0; k < AUDIO_FFT_BINS; k++)
+    {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+        {
+            int phase = (k * n) % AUDIO_FFT_SIZE;
+            re += windowed[n] * cosTable[phase];
+            im -= windowed[n] * cosTable[(phase + 3 * AUDIO_FFT_SIZE / 4) % AUDIO_FFT_SIZE]; // sin
+        }
+        re /= FFT_HALF;
+        im /= FFT_HALF;
+
+        double er = spectrum[2 * k] - re;
+        double ei = spectrum[2 * k + 1] - im;
+        signal += re * re + im * im;
+        noise += er * er + ei * ei;
+    }
+    return 10.0 * log10(signal / (noise + 1e-9));
+}
+
+static float measure_us_per_fft(const int16_t *input, bool simd)
+{
+    static int32_t spectrum[AUDIO_FFT_BINS * 2];
+    const int iterations = 200;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++)
+    {
+        run_fft(input, spectrum, simd);
+    }
+    return (float)(esp_timer_get_time() - start) / iterations;
+}
+
+void audio_fft_self_test()
+{
+    if (!initialized)
+        return;
+
+    // Two tones plus a deterministic pseudo-random noise floor
+    static int16_t input[AUDIO_FFT_SIZE];
+    uint32_t lfsr = 0xACE1u;
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        double noise = ((int32_t)(lfsr >> 16) - 32768) / 32768.0 * 600.0;
+        double v = 12000.0 * sin(2.0 * M_PI * 17.3 * n / AUDIO_FFT_SIZE) +
+                   6000.0 * sin(2.0 * M_PI * 61.8 * n / AUDIO_FFT_SIZE) + noise;
+        input[n] = (int16_t)v;
+    }
+
+    double scalarSnr = measure_snr_db(input, false);
+    float scalarUs = measure_us_per_fft(input, false);
+    Serial0.printf("📊 FFT scalar: SNR %.1f dB vs double reference, %.1f us/frame\n", scalarSnr, scalarUs);
+
+#if AUDIO_FFT_HAS_SIMD
+    if (useSimd)
+    {
+        double simdSnr = measure_snr_db(input, true);
+        float simdUs = measure_us_per_fft(input, true);
+        Serial0.printf("📊 FFT SIMD: SNR %.1f dB vs double reference, %.1f us/frame\n", simdSnr, simdUs);
+
+        // Never trust a vector path that disagrees with the reference
+        if (simdSnr < scalarSnr - 6.0)
+        {
+            Serial0.println("⚠️ SIMD FFT failed accuracy check - using scalar path");
+            useSimd = false;
+        }
+    }
+#endif
+}
+#endif // AUDIO_FFT_SELF_TEST
@@ -0,0 +1,172 @@
+#include "audio_frontend.h"
+#include "audio_math.h"
+#include <math.h>
+#include <algorithm>
+
+#define BENCHMARK_ITERATIONS 200
+
+static inline int16_t saturate16(int32_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+void audio_frontend_init(AudioFrontEnd &fe)
+{
+    fe.dcPrevInput = 0;
+    fe.dcState = 0;
+    fe.agcEnabled = false;
+    fe.agcGainQ8 = 1 << 8;
+}
+
+void audio_frontend_convert(const int32_t *raw, int16_t *out, int count)
+{
+    // Scalar, four samples per iteration: independent loads/shifts keep the
+    // pipeline busy and the clamps compile to MIN/MAX. Not PIE SIMD: esp-dsp has
+    // no saturating 32 -> 16 bit narrowing to build it on.
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int32_t a = raw[i] >> FRONTEND_INPUT_SHIFT;
+        int32_t b = raw[i + 1] >> FRONTEND_INPUT_SHIFT;
+        int32_t c = raw[i + 2] >> FRONTEND_INPUT_SHIFT;
+        int32_t d = raw[i + 3] >> FRONTEND_INPUT_SHIFT;
+        out[i] = saturate16(a);
+        out[i + 1] = saturate16(b);
+        out[i + 2] = saturate16(c);
+        out[i + 3] = saturate16(d);
+    }
+    for (; i < count; i++)
+    {
+        out[i] = saturate16(raw[i] >> FRONTEND_INPUT_SHIFT);
+    }
+}
+
+void audio_frontend_dc_block(AudioFrontEnd &fe, int16_t *samples, int count)
+{
+    int32_t prev = fe.dcPrevInput;
+    int32_t state = fe.dcState;
+
+    for (int i = 0; i < count; i++)
+    {
+        int32_t x = samples[i];
+        // Extra fractional bits in the state avoid limit cycles and DC creep
+        state = ((x - prev) << FRONTEND_DC_SHIFT) + state - (state >> FRONTEND_DC_SHIFT);
+        prev = x;
+        samples[i] = saturate16(state >> FRONTEND_DC_SHIFT);
+    }
+
+    fe.dcPrevInput = prev;
+    fe.dcState = state;
+}
+
+void audio_frontend_measure(const int16_t *samples, int count, uint16_t *rms, uint16_t *peak)
+{
+    uint64_t sumSquares = 0;
+    int32_t maxAbs = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int32_t s = samples[i];
+        sumSquares += (uint32_t)(s * s);
+        int32_t a = s < 0 ? -s : s;
+        if (a > maxAbs)
+            maxAbs = a;
+    }
+
+    *rms = (uint16_t)isqrt32((uint32_t)(sumSquares / count));
+    *peak = (uint16_t)std::min(maxAbs, (int32_t)32767);
+}
+
+static void apply_agc(AudioFrontEnd &fe, int16_t *samples, int count, uint16_t inputRms)
+{
+    // Update the gain from this block's level: drop at once if the target would be
+    // exceeded, rise slowly (~+0.13 dB per block) otherwise; freeze in silence
+    if (inputRms >= FRONTEND_AGC_MIN_RMS)
+    {
+        int32_t desired = (FRONTEND_AGC_TARGET_RMS << 8) / inputRms;
+        desired = std::min(std::max(desired, (int32_t)1 << 8), (int32_t)FRONTEND_AGC_MAX_GAIN_Q8);
+        if (desired < fe.agcGainQ8)
+            fe.agcGainQ8 = desired;
+        else
+            fe.agcGainQ8 = std::min(desired, fe.agcGainQ8 + std::max(fe.agcGainQ8 >> 6, (int32_t)1));
+    }
+
+    if (fe.agcGainQ8 == (1 << 8))
+        return;
+
+    for (int i = 0; i < count; i++)
+    {
+        samples[i] = saturate16((samples[i] * fe.agcGainQ8) >> 8);
+    }
+}
+
+void audio_frontend_process(AudioFrontEnd &fe, const int32_t *raw, int16_t *out, int count,
+                            uint16_t *rms, uint16_t *peak)
+{
+    audio_frontend_convert(raw, out, count);
+    audio_frontend_dc_block(fe, out, count);
+    audio_frontend_measure(out, count, rms, peak);
+
+    if (fe.agcEnabled)
+    {
+        apply_agc(fe, out, count, *rms);
+        audio_frontend_measure(out, count, rms, peak);
+    }
+}
+
+void audio_frontend_benchmark(int64_t (*clockUs)(), AudioFrontEndTimings &timings)
+{
+    static int32_t raw[FRONTEND_BENCHMARK_SAMPLES];
+    static int16_t out[FRONTEND_BENCHMARK_SAMPLES];
+
+    // Speech-level tone with a DC offset, as the INMP441 delivers it
+    for (int i = 0; i < FRONTEND_BENCHMARK_SAMPLES; i++)
+    {
+        float v = 0.01f * sinf(2.0f * (float)M_PI * 440.0f * i / 16000.0f) + 0.002f;
+        raw[i] = (int32_t)(v * 8388607.0f) << 8;
+    }
+
+    // Previous path: masked shift, float normalize and float RMS
+    volatile float floatLevel = 0.0f;
+    int64_t start = clockUs();
+    for (int iter = 0; iter < BENCHMARK_ITERATIONS; iter++)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < FRONTEND_BENCHMARK_SAMPLES; i++)
+        {
+            int16_t sample = (raw[i] >> FRONTEND_INPUT_SHIFT) & 0xFFFF;
+            out[i] = sample;
+            float normalized = (float)sample / 32768.0f;
+            sum += normalized * normalized;
+        }
+        floatLevel = sqrtf(sum / FRONTEND_BENCHMARK_SAMPLES);
+    }
+    timings.floatUs = (float)(clockUs() - start) / BENCHMARK_ITERATIONS;
+    timings.floatLevel = floatLevel;
+
+    // Same work in Q15 (conversion + level), then the full chain with and without AGC
+    start = clockUs();
+    for (int iter = 0; iter < BENCHMARK_ITERATIONS; iter++)
+    {
+        audio_frontend_convert(raw, out, FRONTEND_BENCHMARK_SAMPLES);
+        audio_frontend_measure(out, FRONTEND_BENCHMARK_SAMPLES, &timings.rms, &timings.peak);
+    }
+    timings.convertUs = (float)(clockUs() - start) / BENCHMARK_ITERATIONS;
+
+    AudioFrontEnd fe;
+    audio_frontend_init(fe);
+    start = clockUs();
+    for (int iter = 0; iter < BENCHMARK_ITERATIONS; iter++)
+    {
+        audio_frontend_process(fe, raw, out, FRONTEND_BENCHMARK_SAMPLES, &timings.rms, &timings.peak);
+    }
+    timings.chainUs = (float)(clockUs() - start) / BENCHMARK_ITERATIONS;
+
+    fe.agcEnabled = true;
+    start = clockUs();
+    for (int iter = 0; iter < BENCHMARK_ITERATIONS; iter++)
+    {
+        audio_frontend_process(fe, raw, out, FRONTEND_BENCHMARK_SAMPLES, &timings.rms, &timings.peak);
+    }
+    timings.agcUs = (float)(clockUs() - start) / BENCHMARK_ITERATIONS;
+}
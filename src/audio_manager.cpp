@@ -1,8 +1,13 @@
 #include "audio_manager.h"
+#include "audio_stream_player.h"
 #include <math.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 AudioManager audioManager;
 
+static_assert(CAPTURE_BLOCK_SAMPLES % SPECTRUM_HOP_SAMPLES == 0, "Spectrum hops must tile a capture block");
+
 AudioManager::AudioManager()
 {
     initialized = false;
@@ -10,16 +15,37 @@ AudioManager::AudioManager()
     recording = false;
     currentVolume = 50; // Default 50% volume
 
+    commandQueue = nullptr;
+    outputTask = nullptr;
+    outputBlock = nullptr;
+
     // Initialize buffers
-    audioInputBuffer = nullptr;
-    audioOutputBuffer = nullptr;
     fftBuffer = nullptr;
     currentLevel = 0.0f;
 
+    captureDmaBuffer = nullptr;
+    captureTask = nullptr;
+    i2sEventQueue = nullptr;
+    dmaOverflows = 0;
+    levelReader = {0, 0};
+    spectrumReader = {0, 0};
+    audio_frontend_init(frontEnd);
+    audio_vad_init(vad);
+    spectrumFramesSkipped = 0;
+
+    spectrumTask = nullptr;
+    memset(spectrumWindow, 0, sizeof(spectrumWindow));
+    attackCoeff = 1.0f;
+    releaseCoeff = 1.0f;
+    lastOnsetUs = 0;
+    spectrumSeq.store(0);
+    memset(&spectrumFrame, 0, sizeof(spectrumFrame));
+
     // Initialize frequency bands
     for (int i = 0; i < NUM_BANDS; i++)
     {
         frequencyBands[i] = 0.0f;
+        smoothedBands[i] = 0.0f;
     }
 }
 
@@ -28,217 +54,270 @@ bool AudioManager::init()
     Serial0.println("Initializing I2S Audio System...");
 
     // Allocate audio buffers
-    audioInputBuffer = (int16_t *)malloc(BUFFER_SIZE * sizeof(int16_t));
-    audioOutputBuffer = (int16_t *)malloc(BUFFER_SIZE * sizeof(int16_t));
-    fftBuffer = (float *)malloc(FFT_SIZE * sizeof(float));
+    outputBlock = (int32_t *)heap_caps_malloc(AUDIO_OUTPUT_BLOCK_FRAMES * sizeof(int32_t),
+                                              MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    fftBuffer = (uint32_t *)malloc(AUDIO_FFT_BINS * sizeof(uint32_t));
+    captureDmaBuffer = (int32_t *)heap_caps_malloc(CAPTURE_BLOCK_SAMPLES * sizeof(int32_t),
+                                                   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
 
-    if (!audioInputBuffer || !audioOutputBuffer || !fftBuffer)
+    if (!outputBlock || !fftBuffer || !captureDmaBuffer || !captureRing.init())
     {
         Serial0.println("Failed to allocate audio buffers");
         return false;
     }
 
-    // Initially configure for output (speaker)
-    if (!configureI2SForOutput())
+    // Spectrum analyzer tables (window, twiddles, octave band edges)
+    audio_fft_init(INPUT_SAMPLE_RATE, NUM_BANDS);
+    Serial0.printf("✅ FFT initialized: %d-point Q15 real FFT, %d bands, %s path\n",
+                   AUDIO_FFT_SIZE, NUM_BANDS, audio_fft_uses_simd() ? "SIMD" : "scalar");
+#ifdef AUDIO_FFT_SELF_TEST
+    audio_fft_self_test();
+#endif
+#ifdef AUDIO_FRONTEND_BENCHMARK
+    AudioFrontEndTimings timings;
+    audio_frontend_benchmark(esp_timer_get_time, timings);
+    Serial0.printf("🎚️ Mic front end per %d-sample block: float convert+RMS %.1f us (level %.3f), "
+                   "Q15 convert+RMS/peak %.1f us, +DC block %.1f us, +AGC %.1f us (rms %u peak %u)\n",
+                   FRONTEND_BENCHMARK_SAMPLES, timings.floatUs, timings.floatLevel, timings.convertUs,
+                   timings.chainUs, timings.agcUs, timings.rms, timings.peak);
+#endif
+
+    // Configure the port once: speaker and microphone run simultaneously
+    if (!configureI2S())
     {
-        Serial0.println("Failed to configure I2S for output");
+        Serial0.println("Failed to configure I2S");
         return false;
     }
 
-    initialized = true;
-    Serial0.println("I2S Audio System initialized successfully!");
-    return true;
-}
-
-bool AudioManager::configureI2SForOutput()
-{
-    Serial0.println("Configuring I2S for audio output...");
-
-    // Uninstall existing driver if present (ignore errors if not installed)
-    esp_err_t uninstall_err = i2s_driver_uninstall(I2S_NUM_0);
-    if (uninstall_err != ESP_OK && uninstall_err != ESP_ERR_INVALID_STATE) {
-        Serial0.printf("Warning: I2S uninstall returned: %s\n", esp_err_to_name(uninstall_err));
+    // Output task owns the synth; callers only post commands
+    synth.init(OUTPUT_SAMPLE_RATE);
+    commandQueue = xQueueCreate(AUDIO_COMMAND_QUEUE_LEN, sizeof(AudioCommand));
+    if (!commandQueue ||
+        xTaskCreatePinnedToCore(outputTaskFunction, "AudioOutput", AUDIO_OUTPUT_TASK_STACK, this,
+                                AUDIO_OUTPUT_TASK_PRIORITY, &outputTask, AUDIO_OUTPUT_TASK_CORE) != pdPASS)
+    {
+        Serial0.println("Failed to start audio output task");
+        return false;
     }
 
-    // Configure I2S for output (MAX98357A)
-    i2s_config_t i2s_config = {
-        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-        .sample_rate = OUTPUT_SAMPLE_RATE,
-        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-        .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-        .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
-        .dma_buf_len = 256,
-        .use_apll = true, // Use APLL for better audio quality
-        .tx_desc_auto_clear = true,
-        .fixed_mclk = 0};
+    // One-pole smoothing per hop, from the attack/release time constants
+    const float hopMs = SPECTRUM_HOP_SAMPLES * 1000.0f / INPUT_SAMPLE_RATE;
+    attackCoeff = 1.0f - expf(-hopMs / SPECTRUM_ATTACK_MS);
+    releaseCoeff = 1.0f - expf(-hopMs / SPECTRUM_RELEASE_MS);
 
-    esp_err_t err = i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL);
-    if (err != ESP_OK)
+    if (xTaskCreatePinnedToCore(spectrumTaskFunction, "AudioSpectrum", SPECTRUM_TASK_STACK, this,
+                                SPECTRUM_TASK_PRIORITY, &spectrumTask, SPECTRUM_TASK_CORE) != pdPASS)
     {
-        Serial0.printf("Failed to install I2S driver for output: %s\n", esp_err_to_name(err));
+        Serial0.println("Failed to start spectrum task");
         return false;
     }
 
-    // Set I2S pins for output
-    i2s_pin_config_t pin_config = {
-        .bck_io_num = I2S_SCK_PIN,
-        .ws_io_num = I2S_WS_PIN,
-        .data_out_num = I2S_SD_OUT_PIN, // GPIO21 for MAX98357A
-        .data_in_num = I2S_PIN_NO_CHANGE};
-
-    err = i2s_set_pin(I2S_NUM_0, &pin_config);
-    if (err != ESP_OK)
+    // Capture runs continuously; recording only decides whether consumers read it
+    if (xTaskCreatePinnedToCore(captureTaskFunction, "AudioCapture", CAPTURE_TASK_STACK, this,
+                                CAPTURE_TASK_PRIORITY, &captureTask, CAPTURE_TASK_CORE) != pdPASS)
     {
-        Serial0.printf("Failed to set I2S pins for output: %s\n", esp_err_to_name(err));
+        Serial0.println("Failed to start audio capture task");
         return false;
     }
 
-    Serial0.println("I2S configured for audio output (MAX98357A)");
+    initialized = true;
+    Serial0.println("I2S Audio System initialized successfully!");
     return true;
 }
 
-bool AudioManager::configureI2SForInput()
+bool AudioManager::configureI2S()
 {
-    Serial0.println("Configuring I2S for audio input...");
+    Serial0.println("Configuring I2S for full-duplex audio...");
 
-    // Uninstall existing driver (ignore errors if not installed)
-    esp_err_t uninstall_err = i2s_driver_uninstall(I2S_NUM_0);
-    if (uninstall_err != ESP_OK && uninstall_err != ESP_ERR_INVALID_STATE) {
-        Serial0.printf("Warning: I2S uninstall returned: %s\n", esp_err_to_name(uninstall_err));
-    }
-
-    // Configure I2S for input (INMP441)
+    // Full duplex on one port (MAX98357A out, INMP441 in, shared BCLK/WS)
     i2s_config_t i2s_config = {
-        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-        .sample_rate = INPUT_SAMPLE_RATE,
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_RX),
+        .sample_rate = AUDIO_SAMPLE_RATE,
         .bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT,
         .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 4,
-        .dma_buf_len = 256,
+        .dma_buf_count = CAPTURE_DMA_BUF_COUNT,
+        .dma_buf_len = CAPTURE_BLOCK_SAMPLES,
         .use_apll = true, // Use APLL for stable clock
-        .tx_desc_auto_clear = false,
+        .tx_desc_auto_clear = true, // Speaker idles on silence between tones
         .fixed_mclk = 0};
 
-    esp_err_t err = i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL);
+    // Event queue reports RX DMA overflows to the capture task
+    esp_err_t err = i2s_driver_install(I2S_NUM_0, &i2s_config, I2S_EVENT_QUEUE_LEN, &i2sEventQueue);
     if (err != ESP_OK)
     {
-        Serial0.printf("Failed to install I2S driver for input: %s\n", esp_err_to_name(err));
+        Serial0.printf("Failed to install I2S driver: %s\n", esp_err_to_name(err));
         return false;
     }
 
-    // Set I2S pins for input
     i2s_pin_config_t pin_config = {
         .bck_io_num = I2S_SCK_PIN,
         .ws_io_num = I2S_WS_PIN,
-        .data_out_num = I2S_PIN_NO_CHANGE,
-        .data_in_num = I2S_SD_IN_PIN // GPIO13 for INMP441
+        .data_out_num = I2S_SD_OUT_PIN, // GPIO21 for MAX98357A
+        .data_in_num = I2S_SD_IN_PIN    // GPIO13 for INMP441
     };
 
     err = i2s_set_pin(I2S_NUM_0, &pin_config);
     if (err != ESP_OK)
     {
-        Serial0.printf("Failed to set I2S pins for input: %s\n", esp_err_to_name(err));
+        Serial0.printf("Failed to set I2S pins: %s\n", esp_err_to_name(err));
         return false;
     }
 
-    Serial0.println("I2S configured for audio input (INMP441)");
+    Serial0.printf("I2S configured full duplex: %d Hz, 32-bit slots (MAX98357A + INMP441)\n", AUDIO_SAMPLE_RATE);
     return true;
 }
 
 void AudioManager::playBeep(uint16_t frequency, uint16_t duration)
+{
+    SynthNote note = {0, frequency, duration, 100, WAVE_SINE};
+    if (playSequence(&note, 1))
+    {
+        Serial0.printf("Playing beep: %dHz for %dms\n", frequency, duration);
+    }
+}
+
+bool AudioManager::playSequence(const SynthNote *notes, uint8_t count)
 {
     if (!initialized)
     {
         Serial0.println("Audio not initialized!");
-        return;
+        return false;
     }
 
-    bool wasRecording = recording;
+    AudioCommand command;
+    command.type = AUDIO_CMD_SEQUENCE;
+    command.noteCount = min(count, (uint8_t)SYNTH_MAX_SEQUENCE_NOTES);
+    memcpy(command.notes, notes, command.noteCount * sizeof(SynthNote));
+    if (!sendCommand(command))
+    {
+        return false;
+    }
 
-    // If recording, temporarily switch to output mode
-    if (recording)
+    playing = true;
+    return true;
+}
+
+bool AudioManager::playEarcon(Earcon earcon)
+{
+    const EarconDefinition &definition = audio_earcon(earcon);
+    Serial0.printf("🔔 Earcon: %s\n", definition.name);
+
+    // Synthesize on demand only when the pre-rendered bank is missing
+    if (!audio_earcon_bank_available())
     {
-        stopRecording();
+        return playSequence(definition.notes, definition.noteCount);
     }
 
-    if (playing)
+    if (!initialized)
     {
-        Serial0.println("Already playing audio");
-        if (wasRecording)
-            startRecording(); // Restore recording mode
-        return;
+        Serial0.println("Audio not initialized!");
+        return false;
     }
 
-    Serial0.printf("Playing beep: %dHz for %dms\n", frequency, duration);
+    AudioCommand command;
+    command.type = AUDIO_CMD_EARCON;
+    command.noteCount = 0;
+    command.earcon = earcon;
+    if (!sendCommand(command))
+    {
+        return false;
+    }
 
-    // Ensure we're in output mode
-    configureI2SForOutput();
+    playing = true;
+    return true;
+}
 
-    generateTone(frequency, duration);
+void AudioManager::wakeOutput()
+{
+    AudioCommand command;
+    command.type = AUDIO_CMD_WAKE;
+    command.noteCount = 0;
+    sendCommand(command);
+}
 
-    // Restore recording mode if it was active
-    if (wasRecording)
+bool AudioManager::sendCommand(const AudioCommand &command)
+{
+    // Never block the caller; a full queue means sounds are already backed up
+    if (xQueueSend(commandQueue, &command, 0) != pdTRUE)
     {
-        startRecording();
+        Serial0.println("⚠️ Audio command queue full - sound dropped");
+        return false;
     }
+    return true;
 }
 
-void AudioManager::generateTone(uint16_t frequency, uint16_t duration)
+void AudioManager::outputTaskFunction(void *parameter)
 {
-    playing = true;
-
-    const int samples = (OUTPUT_SAMPLE_RATE * duration) / 1000;
-    const float amplitude = (32767.0 * currentVolume) / 100.0; // Scale by volume
+    static_cast<AudioManager *>(parameter)->outputLoop();
+}
 
-    int16_t *audio_buffer = (int16_t *)malloc(samples * sizeof(int16_t));
-    if (!audio_buffer)
-    {
-        Serial0.println("Failed to allocate audio buffer");
-        playing = false;
-        return;
-    }
+void AudioManager::outputLoop()
+{
+    SynthEnvelope envelope = SYNTH_DEFAULT_ENVELOPE;
+    AudioCommand command;
 
-    // Generate sine wave
-    for (int i = 0; i < samples; i++)
+    for (;;)
     {
-        float t = (float)i / OUTPUT_SAMPLE_RATE;
-        float sample = amplitude * sin(2.0 * PI * frequency * t);
+        // Idle: sleep on the queue. Active: pick up new commands between blocks.
+        TickType_t wait = (synth.isActive() || earconStream.isActive() || audioStreamPlayer.isActive()) ? 0 : portMAX_DELAY;
+        while (xQueueReceive(commandQueue, &command, wait) == pdTRUE)
+        {
+            if (command.type == AUDIO_CMD_STOP)
+            {
+                synth.stopAll();
+                earconStream.stop();
+            }
+            else if (command.type == AUDIO_CMD_EARCON)
+            {
+                earconStream.start(command.earcon);
+            }
+            else if (command.type == AUDIO_CMD_SEQUENCE &&
+                     !synth.schedule(command.notes, command.noteCount, envelope))
+            {
+                Serial0.println("⚠️ Audio sequencer full - notes dropped");
+            }
+            wait = 0;
+        }
 
-        // Apply envelope to avoid clicks (fade in/out)
-        float envelope = 1.0;
-        int fade_samples = OUTPUT_SAMPLE_RATE / 100; // 10ms fade
+        bool synthActive = synth.isActive();
+        bool streamActive = audioStreamPlayer.isActive();
+        if (!synthActive && !streamActive && !earconStream.isActive())
+        {
+            playing = false; // tx_desc_auto_clear keeps the DMA playing silence
+            continue;
+        }
 
-        if (i < fade_samples)
+        int32_t gain = (currentVolume * 32768) / 100;
+        if (!synthActive && !streamActive)
         {
-            envelope = (float)i / fade_samples;
+            // Common case, a lone earcon: flash -> decode -> volume -> DMA slot in one loop
+            earconStream.renderSlots(outputBlock, AUDIO_OUTPUT_BLOCK_FRAMES, gain);
         }
-        else if (i > samples - fade_samples)
+        else
         {
-            envelope = (float)(samples - i) / fade_samples;
+            // Mix one block, then master volume and saturation into 32-bit I2S slots
+            memset(outputBlock, 0, AUDIO_OUTPUT_BLOCK_FRAMES * sizeof(int32_t));
+            synth.mix(outputBlock, AUDIO_OUTPUT_BLOCK_FRAMES);
+            audioStreamPlayer.mix(outputBlock, AUDIO_OUTPUT_BLOCK_FRAMES);
+            if (earconStream.isActive())
+            {
+                earconStream.mix(outputBlock, AUDIO_OUTPUT_BLOCK_FRAMES);
+            }
+
+            for (int i = 0; i < AUDIO_OUTPUT_BLOCK_FRAMES; i++)
+            {
+                int32_t sample = constrain(outputBlock[i], -65535, 65535); // Keeps sample * gain in 32 bits
+                sample = constrain((sample * gain) >> 15, -32768, 32767);
+                outputBlock[i] = sample << 16;
+            }
         }
 
-        audio_buffer[i] = (int16_t)(sample * envelope);
+        // Paced by the DMA: blocks only while all TX buffers are queued
+        size_t bytesWritten;
+        i2s_write(I2S_NUM_0, outputBlock, AUDIO_OUTPUT_BLOCK_FRAMES * sizeof(int32_t), &bytesWritten, portMAX_DELAY);
     }
-
-    // Write to I2S
-    size_t bytes_written;
-    esp_err_t err = i2s_write(I2S_NUM_0, audio_buffer, samples * sizeof(int16_t), &bytes_written, portMAX_DELAY);
-
-    if (err != ESP_OK)
-    {
-        Serial0.printf("I2S write failed: %s\n", esp_err_to_name(err));
-    }
-    else
-    {
-        Serial0.printf("Wrote %d bytes to I2S\n", bytes_written);
-    }
-
-    free(audio_buffer);
-    playing = false;
 }
 
 void AudioManager::setVolume(uint8_t volume)
@@ -256,8 +335,11 @@ void AudioManager::stop()
 {
     if (playing)
     {
-        i2s_zero_dma_buffer(I2S_NUM_0);
-        playing = false;
+        // Voices fade out through their release; the DMA drains into silence
+        AudioCommand command;
+        command.type = AUDIO_CMD_STOP;
+        command.noteCount = 0;
+        sendCommand(command);
         Serial0.println("Audio stopped");
     }
 }
@@ -277,11 +359,9 @@ bool AudioManager::startRecording()
         return true;
     }
 
-    // Configure I2S for input (microphone)
-    configureI2SForInput();
-
-    // Clear any existing data in DMA buffers
-    i2s_zero_dma_buffer(I2S_NUM_0);
+    // Capture is always running; consumers start at the newest block
+    captureRing.attachReader(levelReader);
+    captureRing.attachReader(spectrumReader);
 
     recording = true;
     Serial0.println("Started audio recording");
@@ -297,132 +377,239 @@ void AudioManager::stopRecording()
 
     recording = false;
 
-    // Reconfigure I2S back to output mode
-    configureI2SForOutput();
+    Serial0.printf("Stopped audio recording (%lu blocks, %lu DMA overflows, %lu level / %lu spectrum overruns)\n",
+                   (unsigned long)captureRing.getBlocksWritten(), (unsigned long)dmaOverflows,
+                   (unsigned long)levelReader.overruns, (unsigned long)spectrumReader.overruns);
 
-    Serial0.println("Stopped audio recording");
+    VadStats vadStats = getVadStats();
+    Serial0.printf("🗣️ Activity gate: %.1f%% duty cycle, %lu onsets, noise floor %u, %lu FFT frames skipped\n",
+                   vadStats.dutyCycle * 100.0f, (unsigned long)vadStats.onsets, vadStats.noiseFloor,
+                   (unsigned long)spectrumFramesSkipped);
 }
 
-bool AudioManager::isRecording()
+void AudioManager::captureTaskFunction(void *parameter)
 {
-    return recording;
+    static_cast<AudioManager *>(parameter)->captureLoop();
 }
 
-float AudioManager::getAudioLevel()
+void AudioManager::captureLoop()
 {
-    if (!recording)
+    const size_t blockBytes = CAPTURE_BLOCK_SAMPLES * sizeof(int32_t);
+
+    for (;;)
     {
-        return 0.0;
-    }
+        // Fill one full block; a short read only happens on timeout
+        size_t filled = 0;
+        while (filled < blockBytes)
+        {
+            size_t bytesRead = 0;
+            i2s_read(I2S_NUM_0, (uint8_t *)captureDmaBuffer + filled, blockBytes - filled,
+                     &bytesRead, pdMS_TO_TICKS(CAPTURE_READ_TIMEOUT_MS));
+            filled += bytesRead;
+        }
 
-    // Read audio data and calculate RMS level
-    int16_t audio_buffer[64];
-    size_t bytes_read;
+        // Q15 front end (saturating conversion, DC removal, optional AGC) straight
+        // into the ring slot; the level is computed once here for every consumer
+        AudioBlock *block = captureRing.beginWrite();
+        audio_frontend_process(frontEnd, captureDmaBuffer, block->samples, CAPTURE_BLOCK_SAMPLES,
+                               &block->rms, &block->peak);
 
-    esp_err_t err = i2s_read(I2S_NUM_0, audio_buffer, sizeof(audio_buffer), &bytes_read, 10);
-    if (err != ESP_OK || bytes_read == 0)
-    {
-        return 0.0;
+        bool onset;
+        bool active = audio_vad_process(vad, block->samples, CAPTURE_BLOCK_SAMPLES, block->rms, &onset);
+        block->flags = (active ? AUDIO_BLOCK_ACTIVE : 0) | (onset ? AUDIO_BLOCK_ONSET : 0);
+        captureRing.commitWrite(esp_timer_get_time());
+
+        if (recording)
+        {
+            xTaskNotifyGive(spectrumTask);
+        }
+
+        drainI2SEvents();
     }
+}
 
-    // Calculate RMS
-    float sum = 0.0;
-    int samples = bytes_read / sizeof(int16_t);
+void AudioManager::drainI2SEvents()
+{
+    if (!i2sEventQueue)
+    {
+        return;
+    }
 
-    for (int i = 0; i < samples; i++)
+    i2s_event_t event;
+    while (xQueueReceive(i2sEventQueue, &event, 0) == pdTRUE)
     {
-        float sample = (float)audio_buffer[i] / 32768.0;
-        sum += sample * sample;
+        if (event.type == I2S_EVENT_RX_Q_OVF)
+        {
+            dmaOverflows++;
+        }
     }
+}
 
-    return sqrt(sum / samples);
+bool AudioManager::isRecording()
+{
+    return recording;
 }
 
-void AudioManager::processAudioData()
+float AudioManager::getAudioLevel()
 {
     if (!recording)
     {
-        return;
+        return 0.0;
     }
 
-    // Read audio data for processing
-    int32_t samples[BUFFER_SIZE];
-    size_t bytes_read;
+    // RMS over every block captured since the last call (keep the last level if none),
+    // combined from the per-block levels the front end already computed
+    uint64_t sumSquares = 0;
+    int blocks = 0;
+    const AudioBlock *block;
 
-    esp_err_t err = i2s_read(I2S_NUM_0, samples, sizeof(samples), &bytes_read, 10);
-    if (err != ESP_OK || bytes_read == 0)
+    while ((block = captureRing.peek(levelReader)) != nullptr)
     {
-        return;
+        uint32_t rms = block->rms;
+        if (captureRing.release(levelReader))
+        {
+            sumSquares += rms * rms;
+            blocks++;
+        }
     }
 
-    int num_samples = bytes_read / sizeof(int32_t);
-
-    // Convert 32-bit samples to 16-bit and calculate RMS level
-    float sum = 0.0;
-    for (int i = 0; i < num_samples && i < BUFFER_SIZE; i++)
+    if (blocks > 0)
     {
-        // Convert from 32-bit to 16-bit (INMP441 outputs 24-bit data in 32-bit format)
-        int16_t sample = (samples[i] >> 11) & 0xFFFF;
-        audioInputBuffer[i] = sample;
-
-        float normalized = (float)sample / 32768.0f;
-        sum += normalized * normalized;
+        currentLevel = sqrtf((float)(sumSquares / blocks)) / 32768.0f;
     }
 
-    // Update current audio level (RMS)
-    currentLevel = sqrt(sum / num_samples);
+    return currentLevel;
+}
 
-    // Perform FFT for frequency analysis
-    if (num_samples >= FFT_SIZE)
-    {
-        performFFT(audioInputBuffer, fftBuffer);
-        updateFrequencyBands(fftBuffer);
-    }
+void AudioManager::spectrumTaskFunction(void *parameter)
+{
+    static_cast<AudioManager *>(parameter)->spectrumLoop();
 }
 
-void AudioManager::performFFT(int16_t *samples, float *output)
+void AudioManager::spectrumLoop()
 {
-    // Simple FFT implementation for frequency analysis
-    // This is a simplified version - you might want to use a proper FFT library
-    for (int i = 0; i < FFT_SIZE; i++)
+    for (;;)
     {
-        if (i < BUFFER_SIZE)
+        // Woken by the capture task for every block while recording
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAPTURE_READ_TIMEOUT_MS));
+        if (!recording)
         {
-            output[i] = (float)samples[i] / 32768.0f;
+            continue;
         }
-        else
+
+        const AudioBlock *block;
+        while ((block = captureRing.peek(spectrumReader)) != nullptr)
         {
-            output[i] = 0.0f;
+            memcpy(spectrumBlock, block->samples, sizeof(spectrumBlock));
+            uint8_t flags = block->flags;
+            int64_t blockTimestamp = block->timestampUs;
+            if (!captureRing.release(spectrumReader))
+            {
+                continue; // Overwritten while copying
+            }
+
+            if (flags & AUDIO_BLOCK_ONSET)
+            {
+                lastOnsetUs = blockTimestamp;
+            }
+
+            // Slide the window one hop at a time: two 50% overlapped frames per block
+            for (int offset = 0; offset < CAPTURE_BLOCK_SAMPLES; offset += SPECTRUM_HOP_SAMPLES)
+            {
+                memmove(spectrumWindow, spectrumWindow + SPECTRUM_HOP_SAMPLES,
+                        (FFT_SIZE - SPECTRUM_HOP_SAMPLES) * sizeof(int16_t));
+                memcpy(spectrumWindow + FFT_SIZE - SPECTRUM_HOP_SAMPLES, spectrumBlock + offset,
+                       SPECTRUM_HOP_SAMPLES * sizeof(int16_t));
+
+                int samplesAfter = CAPTURE_BLOCK_SAMPLES - offset - SPECTRUM_HOP_SAMPLES;
+                analyzeSpectrumFrame(flags & AUDIO_BLOCK_ACTIVE,
+                                     blockTimestamp - (int64_t)samplesAfter * 1000000 / INPUT_SAMPLE_RATE);
+            }
         }
     }
 }
 
-void AudioManager::updateFrequencyBands(float *fftData)
+void AudioManager::analyzeSpectrumFrame(bool active, int64_t timestampUs)
 {
-    // Simple frequency band calculation
-    int samples_per_band = FFT_SIZE / NUM_BANDS;
+    // Nothing above the noise floor: let the bars fall instead of running the FFT
+    if (active)
+    {
+        performFFT(spectrumWindow, fftBuffer);
+        updateFrequencyBands(fftBuffer);
+    }
+    else
+    {
+        spectrumFramesSkipped++;
+        memset(frequencyBands, 0, sizeof(frequencyBands));
+    }
 
-    for (int band = 0; band < NUM_BANDS; band++)
+    // Fast attack, slow release per band
+    for (int i = 0; i < NUM_BANDS; i++)
     {
-        float sum = 0.0f;
-        int start = band * samples_per_band;
-        int end = start + samples_per_band;
+        float delta = frequencyBands[i] - smoothedBands[i];
+        smoothedBands[i] += delta * (delta > 0.0f ? attackCoeff : releaseCoeff);
+    }
+
+    publishSpectrum(timestampUs);
+}
+
+void AudioManager::publishSpectrum(int64_t timestampUs)
+{
+    // Seqlock writer: odd sequence while the frame is inconsistent
+    uint32_t seq = spectrumSeq.load(std::memory_order_relaxed);
+    spectrumSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
 
-        for (int i = start; i < end && i < FFT_SIZE; i++)
+    memcpy(spectrumFrame.bands, smoothedBands, sizeof(smoothedBands));
+    spectrumFrame.timestampUs = timestampUs;
+    spectrumFrame.onsetUs = lastOnsetUs;
+    spectrumFrame.sequence++;
+
+    spectrumSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool AudioManager::getSpectrumFrame(SpectrumFrame &frame)
+{
+    // Seqlock reader: retry a few times, never wait on the writer
+    for (int attempt = 0; attempt < 4; attempt++)
+    {
+        uint32_t before = spectrumSeq.load(std::memory_order_acquire);
+        if (before & 1)
         {
-            sum += fabs(fftData[i]);
+            continue;
         }
 
-        frequencyBands[band] = sum / samples_per_band;
+        memcpy(&frame, &spectrumFrame, sizeof(frame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (spectrumSeq.load(std::memory_order_relaxed) == before)
+        {
+            return true;
+        }
     }
+    return false;
+}
+
+void AudioManager::performFFT(const int16_t *samples, uint32_t *output)
+{
+    // Hann-windowed Q15 real FFT -> power per bin
+    audio_fft_power(samples, output);
+}
+
+void AudioManager::updateFrequencyBands(uint32_t *fftData)
+{
+    // Octave bands matching the 63Hz-8kHz visualizer labels
+    audio_fft_bands(fftData, frequencyBands, NUM_BANDS);
 }
 
 void AudioManager::getFrequencyBands(float *bands, int numBands)
 {
+    static SpectrumFrame frame = {};
+    getSpectrumFrame(frame); // Keeps the previous frame if the writer was busy
+
     int copyBands = min(numBands, NUM_BANDS);
     for (int i = 0; i < copyBands; i++)
     {
-        bands[i] = frequencyBands[i];
+        bands[i] = frame.bands[i];
     }
 
     // Fill remaining bands with zeros if needed
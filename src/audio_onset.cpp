@@ -0,0 +1,110 @@
+#include "audio_onset.h"
+#include "audio_math.h"
+#include <string.h>
+#include <algorithm>
+
+void onset_init(OnsetDetector &det)
+{
+    memset(&det, 0, sizeof(det));
+    det.lastOnsetUs = -1000000;
+}
+
+void onset_update_reference(OnsetDetector &det, const uint32_t *power)
+{
+    for (int k = ONSET_MIN_BIN; k < AUDIO_FFT_BINS; k++)
+    {
+        det.prevMagnitude[k] = (uint16_t)isqrt32(power[k]);
+    }
+}
+
+bool onset_process(OnsetDetector &det, const uint32_t *power, int64_t timestampUs)
+{
+    // Half-wave rectified magnitude increase over the previous frame
+    uint32_t flux = 0;
+    for (int k = ONSET_MIN_BIN; k < AUDIO_FFT_BINS; k++)
+    {
+        uint16_t magnitude = (uint16_t)isqrt32(power[k]);
+        if (magnitude > det.prevMagnitude[k])
+        {
+            flux += magnitude - det.prevMagnitude[k];
+        }
+        det.prevMagnitude[k] = magnitude;
+    }
+
+    // Adaptive threshold from the recent mean flux
+    uint32_t mean = det.fluxSum / ONSET_HISTORY;
+    uint32_t threshold = std::max((mean * ONSET_THRESHOLD_RATIO_Q8) >> 8, (uint32_t)ONSET_MIN_FLUX);
+    bool onset = flux > threshold && (timestampUs - det.lastOnsetUs) >= ONSET_REFRACTORY_MS * 1000LL;
+
+    // Clamp what enters the history so one clap does not mask the next
+    uint32_t entry = std::min(flux, threshold);
+    det.fluxSum += entry - det.fluxHistory[det.historyPos];
+    det.fluxHistory[det.historyPos] = entry;
+    det.historyPos = (det.historyPos + 1) % ONSET_HISTORY;
+
+    if (onset)
+    {
+        det.lastOnsetUs = timestampUs;
+        det.onsets++;
+    }
+    return onset;
+}
+
+ClapPattern onset_update_pattern(OnsetDetector &det, bool onset, int64_t nowUs)
+{
+    int64_t sinceLast = nowUs - det.lastClapUs;
+
+    if (onset)
+    {
+        if (det.clapCount == 0 || sinceLast > CLAP_MAX_GAP_MS * 1000LL)
+        {
+            det.clapCount = 1;
+        }
+        else if (sinceLast >= CLAP_MIN_GAP_MS * 1000LL)
+        {
+            det.clapCount++;
+        }
+        det.lastClapUs = nowUs;
+
+        if (det.clapCount == 3)
+        {
+            det.clapCount = 0;
+            det.patterns++;
+            return CLAP_TRIPLE;
+        }
+        return CLAP_NONE;
+    }
+
+    if (det.clapCount > 0 && sinceLast > CLAP_MAX_GAP_MS * 1000LL)
+    {
+        uint8_t count = det.clapCount;
+        det.clapCount = 0;
+        if (count == 2)
+        {
+            det.patterns++;
+            return CLAP_DOUBLE;
+        }
+    }
+    return CLAP_NONE;
+}
+
+ClapPattern onset_process_block(OnsetDetector &det, const int16_t *samples, bool active, int64_t timestampUs,
+                                uint32_t *power, bool *onset)
+{
+    *onset = false;
+
+    // Quiet blocks cost no FFT apart from an occasional background refresh
+    if (active)
+    {
+        det.quietBlocks = 0;
+        audio_fft_power(samples, power);
+        *onset = onset_process(det, power, timestampUs);
+    }
+    else if (++det.quietBlocks % ONSET_REFERENCE_REFRESH_BLOCKS == 0)
+    {
+        audio_fft_power(samples, power);
+        onset_update_reference(det, power);
+    }
+
+    return onset_update_pattern(det, *onset, timestampUs);
+}
@@ -0,0 +1,370 @@
+#include "audio_recorder.h"
+#include "audio_manager.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+AudioRecorder audioRecorder;
+
+#define PCM_HEADER_BYTES 44
+#define ADPCM_HEADER_BYTES 60 // RIFF + fmt (20) + fact + data
+
+static_assert(RECORD_WRITE_BUFFER_BYTES % RECORD_SECTOR_BYTES == 0, "Write buffers must be whole sectors");
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, v & 0xFFFF);
+    put16(p + 2, v >> 16);
+}
+
+AudioRecorder::AudioRecorder()
+{
+    buffers[0] = buffers[1] = nullptr;
+    bufferFree[0] = bufferFree[1] = nullptr;
+    activeBuffer = 0;
+    bufferFill = 0;
+
+    adpcmStaging = nullptr;
+    stagingCount = 0;
+    ima_adpcm_reset(adpcmState);
+
+    path[0] = '\0';
+    format = RECORD_FORMAT_IMA_ADPCM;
+    reader = {0, 0};
+    recording = false;
+    stopRequested = false;
+    skipSilence = false;
+    encoderTask = nullptr;
+    writerTask = nullptr;
+    writeQueue = nullptr;
+    stopCallback = nullptr;
+    memset(&stats, 0, sizeof(stats));
+    writeUs = 0;
+}
+
+bool AudioRecorder::init()
+{
+    Serial0.println("Initializing audio recorder...");
+
+    buffers[0] = (uint8_t *)ps_malloc(RECORD_WRITE_BUFFER_BYTES);
+    buffers[1] = (uint8_t *)ps_malloc(RECORD_WRITE_BUFFER_BYTES);
+    adpcmStaging = (int16_t *)heap_caps_malloc(IMA_ADPCM_SAMPLES_PER_BLOCK * sizeof(int16_t),
+                                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!buffers[0] || !buffers[1] || !adpcmStaging)
+    {
+        Serial0.println("❌ Failed to allocate recorder buffers");
+        return false;
+    }
+
+    // The encoder always owns activeBuffer (0 at start); the writer returns buffers via bufferFree
+    bufferFree[0] = xSemaphoreCreateBinary();
+    bufferFree[1] = xSemaphoreCreateBinary();
+    writeQueue = xQueueCreate(2, sizeof(WriteJob));
+    if (!bufferFree[0] || !bufferFree[1] || !writeQueue)
+    {
+        Serial0.println("❌ Failed to create recorder queues");
+        return false;
+    }
+    xSemaphoreGive(bufferFree[1]);
+
+    if (xTaskCreatePinnedToCore(encoderTaskFunction, "RecordEncode", RECORD_ENCODER_TASK_STACK, this,
+                                RECORD_ENCODER_TASK_PRIORITY, &encoderTask, RECORD_TASK_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(writerTaskFunction, "RecordWrite", RECORD_WRITER_TASK_STACK, this,
+                                RECORD_WRITER_TASK_PRIORITY, &writerTask, RECORD_TASK_CORE) != pdPASS)
+    {
+        Serial0.println("❌ Failed to start recorder tasks");
+        return false;
+    }
+
+    Serial0.println("✅ Audio recorder ready");
+    return true;
+}
+
+bool AudioRecorder::start(const char *filePath, RecordFormat recordFormat)
+{
+    if (!encoderTask)
+    {
+        Serial0.println("Audio recorder not initialized!");
+        return false;
+    }
+
+    if (recording)
+    {
+        Serial0.println("Already recording (or previous recording still being written)");
+        return false;
+    }
+
+    file = LittleFS.open(filePath, "w");
+    if (!file)
+    {
+        Serial0.printf("❌ Could not create recording: %s\n", filePath);
+        return false;
+    }
+
+    strlcpy(path, filePath, sizeof(path));
+    format = recordFormat;
+    memset(&stats, 0, sizeof(stats));
+    writeUs = 0;
+    stagingCount = 0;
+    ima_adpcm_reset(adpcmState);
+
+    // Reserve the header at the start of the first buffer; it is patched at stop
+    memset(buffers[activeBuffer], 0, headerSize());
+    bufferFill = headerSize();
+
+    audioManager.getCaptureRing().attachReader(reader);
+    stopRequested = false;
+    stopCallback = nullptr;
+    recording = true;
+    xTaskNotifyGive(encoderTask);
+
+    Serial0.printf("🎙️ Recording to %s (%s)\n", path, format == RECORD_FORMAT_IMA_ADPCM ? "IMA-ADPCM" : "PCM16");
+    return true;
+}
+
+void AudioRecorder::stop(void (*onStopped)())
+{
+    if (!recording || stopRequested)
+    {
+        return;
+    }
+
+    // Callback before the request: the encoder reads it once it sees the stop
+    stopCallback = onStopped;
+    stopRequested = true;
+}
+
+uint32_t AudioRecorder::headerSize() const
+{
+    return format == RECORD_FORMAT_IMA_ADPCM ? ADPCM_HEADER_BYTES : PCM_HEADER_BYTES;
+}
+
+uint32_t AudioRecorder::buildHeader(uint8_t *h, uint32_t dataBytes)
+{
+    uint32_t size = headerSize();
+    memcpy(h, "RIFF", 4);
+    put32(h + 4, size - 8 + dataBytes);
+    memcpy(h + 8, "WAVE", 4);
+    memcpy(h + 12, "fmt ", 4);
+
+    if (format == RECORD_FORMAT_IMA_ADPCM)
+    {
+        put32(h + 16, 20);
+        put16(h + 20, 0x11); // WAVE_FORMAT_IMA_ADPCM
+        put16(h + 22, 1);
+        put32(h + 24, INPUT_SAMPLE_RATE);
+        put32(h + 28, (INPUT_SAMPLE_RATE * IMA_ADPCM_BLOCK_BYTES) / IMA_ADPCM_SAMPLES_PER_BLOCK);
+        put16(h + 32, IMA_ADPCM_BLOCK_BYTES);
+        put16(h + 34, 4);
+        put16(h + 36, 2);
+        put16(h + 38, IMA_ADPCM_SAMPLES_PER_BLOCK);
+        memcpy(h + 40, "fact", 4);
+        put32(h + 44, 4);
+        put32(h + 48, stats.samplesRecorded);
+        memcpy(h + 52, "data", 4);
+        put32(h + 56, dataBytes);
+    }
+    else
+    {
+        put32(h + 16, 16);
+        put16(h + 20, 1); // WAVE_FORMAT_PCM
+        put16(h + 22, 1);
+        put32(h + 24, INPUT_SAMPLE_RATE);
+        put32(h + 28, INPUT_SAMPLE_RATE * 2);
+        put16(h + 32, 2);
+        put16(h + 34, 16);
+        memcpy(h + 36, "data", 4);
+        put32(h + 40, dataBytes);
+    }
+
+    return size;
+}
+
+void AudioRecorder::encoderTaskFunction(void *parameter)
+{
+    static_cast<AudioRecorder *>(parameter)->encoderLoop();
+}
+
+void AudioRecorder::writerTaskFunction(void *parameter)
+{
+    static_cast<AudioRecorder *>(parameter)->writerLoop();
+}
+
+void AudioRecorder::encoderLoop()
+{
+    AudioRingBuffer &ring = audioManager.getCaptureRing();
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (!stopRequested)
+        {
+            const AudioBlock *block = ring.peek(reader);
+            if (!block)
+            {
+                vTaskDelay(pdMS_TO_TICKS(8)); // Half a capture block
+                continue;
+            }
+
+            recordBlock(block);
+            ring.release(reader);
+        }
+
+        // Drain what was captured up to the stop request, then hand over the last buffer
+        const AudioBlock *block;
+        while ((block = ring.peek(reader)) != nullptr)
+        {
+            recordBlock(block);
+            ring.release(reader);
+        }
+        flushStaging();
+        stats.captureOverruns = reader.overruns;
+        submitBuffer(true);
+
+        void (*onStopped)() = stopCallback;
+        if (onStopped)
+        {
+            onStopped();
+        }
+    }
+}
+
+// Voice-activated recordings keep only the blocks the VAD marked active
+void AudioRecorder::recordBlock(const AudioBlock *block)
+{
+    if (skipSilence && !(block->flags & AUDIO_BLOCK_ACTIVE))
+    {
+        stats.silentBlocksSkipped++;
+        return;
+    }
+    encodeBlock(block->samples, CAPTURE_BLOCK_SAMPLES);
+}
+
+void AudioRecorder::encodeBlock(const int16_t *samples, int count)
+{
+    stats.samplesRecorded += count;
+
+    if (format == RECORD_FORMAT_PCM16)
+    {
+        append((const uint8_t *)samples, count * sizeof(int16_t));
+        return;
+    }
+
+    while (count > 0)
+    {
+        int n = min(count, (int)(IMA_ADPCM_SAMPLES_PER_BLOCK - stagingCount));
+        memcpy(adpcmStaging + stagingCount, samples, n * sizeof(int16_t));
+        stagingCount += n;
+        samples += n;
+        count -= n;
+
+        if (stagingCount == IMA_ADPCM_SAMPLES_PER_BLOCK)
+        {
+            uint8_t encoded[IMA_ADPCM_BLOCK_BYTES];
+            ima_adpcm_encode_block(adpcmState, adpcmStaging, encoded);
+            append(encoded, sizeof(encoded));
+            stagingCount = 0;
+        }
+    }
+}
+
+void AudioRecorder::flushStaging()
+{
+    if (format != RECORD_FORMAT_IMA_ADPCM || stagingCount == 0)
+    {
+        return;
+    }
+
+    // Pad the last block with silence; the fact chunk holds the real sample count
+    memset(adpcmStaging + stagingCount, 0, (IMA_ADPCM_SAMPLES_PER_BLOCK - stagingCount) * sizeof(int16_t));
+    uint8_t encoded[IMA_ADPCM_BLOCK_BYTES];
+    ima_adpcm_encode_block(adpcmState, adpcmStaging, encoded);
+    append(encoded, sizeof(encoded));
+    stagingCount = 0;
+}
+
+void AudioRecorder::append(const uint8_t *data, uint32_t length)
+{
+    while (length > 0)
+    {
+        uint32_t n = min(length, (uint32_t)(RECORD_WRITE_BUFFER_BYTES - bufferFill));
+        memcpy(buffers[activeBuffer] + bufferFill, data, n);
+        bufferFill += n;
+        data += n;
+        length -= n;
+
+        if (bufferFill == RECORD_WRITE_BUFFER_BYTES)
+        {
+            submitBuffer(false);
+        }
+    }
+}
+
+void AudioRecorder::submitBuffer(bool finish)
+{
+    WriteJob job = {activeBuffer, bufferFill, finish};
+    xQueueSend(writeQueue, &job, portMAX_DELAY);
+
+    // Switch to the other buffer; waiting here means flash is slower than capture
+    activeBuffer ^= 1;
+    if (xSemaphoreTake(bufferFree[activeBuffer], 0) != pdTRUE)
+    {
+        stats.writerStalls++;
+        xSemaphoreTake(bufferFree[activeBuffer], portMAX_DELAY);
+    }
+    bufferFill = 0;
+}
+
+void AudioRecorder::writerLoop()
+{
+    WriteJob job;
+
+    for (;;)
+    {
+        xQueueReceive(writeQueue, &job, portMAX_DELAY);
+
+        if (job.length > 0)
+        {
+            int64_t start = esp_timer_get_time();
+            size_t written = file.write(buffers[job.buffer], job.length);
+            int64_t elapsed = esp_timer_get_time() - start;
+
+            writeUs += elapsed;
+            stats.bytesWritten += written;
+            stats.maxWriteMs = max(stats.maxWriteMs, (uint32_t)(elapsed / 1000));
+            if (written != job.length)
+            {
+                Serial0.printf("❌ Recording write failed (%u of %lu bytes) - flash full?\n",
+                               (unsigned)written, (unsigned long)job.length);
+            }
+        }
+        xSemaphoreGive(bufferFree[job.buffer]);
+
+        if (job.finish)
+        {
+            // Patch sizes into the header now that the length is known
+            uint8_t header[ADPCM_HEADER_BYTES];
+            uint32_t dataBytes = stats.bytesWritten > headerSize() ? stats.bytesWritten - headerSize() : 0;
+            uint32_t size = buildHeader(header, dataBytes);
+            file.seek(0);
+            file.write(header, size);
+            file.close();
+
+            stats.throughputKBps = writeUs > 0 ? (stats.bytesWritten / 1024.0f) / (writeUs / 1000000.0f) : 0.0f;
+            Serial0.printf("🎙️ Saved %s: %lu samples, %lu bytes, %.1f KB/s sustained, max write %lu ms, "
+                           "%lu capture overruns, %lu writer stalls, %lu silent blocks skipped\n",
+                           path, (unsigned long)stats.samplesRecorded, (unsigned long)stats.bytesWritten,
+                           stats.throughputKBps, (unsigned long)stats.maxWriteMs,
+                           (unsigned long)stats.captureOverruns, (unsigned long)stats.writerStalls,
+                           (unsigned long)stats.silentBlocksSkipped);
+            recording = false;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "audio_ring_buffer.h"
+#include <esp_heap_caps.h>
+
+// Maximum reader lag. Keeping one slot free between the reader and the slot
+// being written gives a consumer a full block period to use a peeked block.
+#define MAX_READER_LAG (CAPTURE_RING_BLOCKS - 2)
+
+#define SEQUENCE_WRITING 0xFFFFFFFFu
+
+AudioRingBuffer::AudioRingBuffer()
+{
+    blocks = nullptr;
+    head.store(0);
+}
+
+bool AudioRingBuffer::init()
+{
+    if (blocks)
+    {
+        return true;
+    }
+
+    // Internal RAM: the capture task writes here every 16 ms, PSRAM would add cache pressure
+    blocks = (AudioBlock *)heap_caps_malloc(CAPTURE_RING_BLOCKS * sizeof(AudioBlock),
+                                            MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!blocks)
+    {
+        Serial0.println("❌ Failed to allocate capture ring buffer");
+        return false;
+    }
+
+    for (int i = 0; i < CAPTURE_RING_BLOCKS; i++)
+    {
+        blocks[i].sequence = SEQUENCE_WRITING;
+        blocks[i].timestampUs = 0;
+    }
+
+    Serial0.printf("✅ Capture ring: %d blocks x %d samples (%d bytes internal RAM)\n",
+                   CAPTURE_RING_BLOCKS, CAPTURE_BLOCK_SAMPLES,
+                   (int)(CAPTURE_RING_BLOCKS * sizeof(AudioBlock)));
+    return true;
+}
+
+AudioBlock *AudioRingBuffer::beginWrite()
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    AudioBlock *block = &blocks[h % CAPTURE_RING_BLOCKS];
+    block->sequence = SEQUENCE_WRITING;
+    std::atomic_thread_fence(std::memory_order_release);
+    return block;
+}
+
+void AudioRingBuffer::commitWrite(int64_t timestampUs)
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    AudioBlock *block = &blocks[h % CAPTURE_RING_BLOCKS];
+    block->timestampUs = timestampUs;
+    block->sequence = h;
+    head.store(h + 1, std::memory_order_release);
+}
+
+void AudioRingBuffer::attachReader(AudioRingReader &reader)
+{
+    reader.next = head.load(std::memory_order_acquire);
+    reader.overruns = 0;
+}
+
+uint32_t AudioRingBuffer::available(const AudioRingReader &reader) const
+{
+    return head.load(std::memory_order_acquire) - reader.next;
+}
+
+void AudioRingBuffer::seekLatest(AudioRingReader &reader)
+{
+    uint32_t h = head.load(std::memory_order_acquire);
+    if (h - reader.next > 1)
+    {
+        reader.next = h - 1;
+    }
+}
+
+const AudioBlock *AudioRingBuffer::peek(AudioRingReader &reader)
+{
+    if (!blocks)
+    {
+        return nullptr;
+    }
+
+    uint32_t h = head.load(std::memory_order_acquire);
+    uint32_t lag = h - reader.next;
+    if (lag == 0)
+    {
+        return nullptr;
+    }
+
+    // Fell behind: skip to the oldest block that is still safe to read
+    if (lag > MAX_READER_LAG)
+    {
+        reader.overruns += lag - MAX_READER_LAG;
+        reader.next = h - MAX_READER_LAG;
+    }
+
+    return &blocks[reader.next % CAPTURE_RING_BLOCKS];
+}
+
+bool AudioRingBuffer::release(AudioRingReader &reader)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = blocks[reader.next % CAPTURE_RING_BLOCKS].sequence == reader.next;
+    if (!intact)
+    {
+        reader.overruns++;
+    }
+    reader.next++;
+    return intact;
+}
@@ -0,0 +1,398 @@
+#include "audio_stream_player.h"
+#include "audio_manager.h"
+#include "wifi_power.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <AudioOutput.h>
+#include <AudioFileSourceBuffer.h>
+#include <AudioFileSourceFS.h>
+#include <AudioFileSourceHTTPStream.h>
+#include <AudioGeneratorAAC.h>
+#include <AudioGeneratorMP3.h>
+
+AudioStreamPlayer audioStreamPlayer;
+
+#define PCM_RING_MASK (STREAM_PCM_RING_SAMPLES - 1)
+static_assert((STREAM_PCM_RING_SAMPLES & PCM_RING_MASK) == 0, "PCM ring size must be a power of two");
+
+// Decoder sink: downmix to mono, linear-resample to the bus rate and push into
+// the player's PCM ring. Returning false makes the generator retry the sample
+// on its next loop(), which throttles decoding to playback speed.
+class StreamPcmOutput : public AudioOutput
+{
+public:
+    StreamPcmOutput(AudioStreamPlayer &player) : player(player) {}
+
+    bool begin() override
+    {
+        previous = 0;
+        phase = 0;
+        updateStep();
+        return true;
+    }
+
+    bool SetRate(int hz) override
+    {
+        hertz = hz;
+        updateStep();
+        return true;
+    }
+
+    bool ConsumeSample(int16_t sample[2]) override
+    {
+        // Worst case outputs per input sample, so a sample is never half consumed
+        if (player.pcmFree() < maxOutputsPerInput)
+        {
+            player.countOverrun();
+            return false;
+        }
+
+        MakeSampleStereo16(sample);
+        int32_t current = ((int32_t)sample[LEFTCHANNEL] + sample[RIGHTCHANNEL]) >> 1;
+
+        // Emit output samples that fall between previous (phase 0) and current (phase 1)
+        while (phase < 0x10000)
+        {
+            player.pcmPush((int16_t)(previous + (((current - previous) * (int32_t)phase) >> 16)));
+            phase += step;
+        }
+        phase -= 0x10000;
+        previous = current;
+        return true;
+    }
+
+    bool stop() override
+    {
+        return true;
+    }
+
+    uint32_t getRate() const { return hertz; }
+
+private:
+    AudioStreamPlayer &player;
+    int32_t previous = 0;
+    uint32_t phase = 0;          // Q16 position between previous and current input sample
+    uint32_t step = 0x10000;     // Q16 input samples per output sample
+    uint32_t maxOutputsPerInput = 1;
+
+    void updateStep()
+    {
+        uint32_t rate = hertz ? hertz : OUTPUT_SAMPLE_RATE;
+        step = (uint32_t)(((uint64_t)rate << 16) / OUTPUT_SAMPLE_RATE);
+        maxOutputsPerInput = (OUTPUT_SAMPLE_RATE + rate - 1) / rate + 1;
+    }
+};
+
+AudioStreamPlayer::AudioStreamPlayer()
+{
+    pcmRing = nullptr;
+    pcmHead.store(0);
+    pcmTail.store(0);
+    pcmStart.store(0);
+    prebuffering = true;
+
+    sourceBuffer = nullptr;
+    requestQueue = nullptr;
+    pipelineTask = nullptr;
+    active = false;
+    decoding = false;
+    holdingRadio = false;
+
+    source = nullptr;
+    bufferedSource = nullptr;
+    generator = nullptr;
+    output = nullptr;
+
+    underruns = 0;
+    overruns = 0;
+    decodeCpuPercent = 0.0f;
+}
+
+bool AudioStreamPlayer::init()
+{
+    Serial0.println("Initializing audio stream player...");
+
+    // Decoded PCM in internal RAM (read by the output task every block),
+    // compressed data in PSRAM
+    pcmRing = (int16_t *)heap_caps_malloc(STREAM_PCM_RING_SAMPLES * sizeof(int16_t),
+                                          MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    sourceBuffer = (uint8_t *)ps_malloc(STREAM_SOURCE_BUFFER_BYTES);
+    output = new StreamPcmOutput(*this);
+    if (!pcmRing || !sourceBuffer || !output)
+    {
+        Serial0.println("❌ Failed to allocate stream buffers");
+        return false;
+    }
+
+    if (!LittleFS.begin(false))
+    {
+        Serial0.println("⚠️ LittleFS not mounted - file playback unavailable (upload a filesystem image)");
+    }
+
+    requestQueue = xQueueCreate(2, sizeof(StreamRequest));
+    if (!requestQueue ||
+        xTaskCreatePinnedToCore(pipelineTaskFunction, "AudioStream", STREAM_TASK_STACK, this,
+                                STREAM_TASK_PRIORITY, &pipelineTask, STREAM_TASK_CORE) != pdPASS)
+    {
+        Serial0.println("❌ Failed to start stream pipeline task");
+        return false;
+    }
+
+    Serial0.println("✅ Audio stream player ready");
+    return true;
+}
+
+bool AudioStreamPlayer::request(StreamSourceType type, const char *path)
+{
+    if (!requestQueue)
+    {
+        return false;
+    }
+
+    StreamRequest req;
+    req.stop = (path == nullptr);
+    req.type = type;
+    strlcpy(req.path, path ? path : "", sizeof(req.path));
+
+    // Replace anything still queued: only the latest request matters
+    xQueueReset(requestQueue);
+    return xQueueSend(requestQueue, &req, 0) == pdTRUE;
+}
+
+bool AudioStreamPlayer::playUrl(const char *url)
+{
+    Serial0.printf("📻 Stream requested: %s\n", url);
+    return request(STREAM_SOURCE_HTTP, url);
+}
+
+bool AudioStreamPlayer::playFile(const char *path)
+{
+    Serial0.printf("📁 File playback requested: %s\n", path);
+    return request(STREAM_SOURCE_FILE, path);
+}
+
+void AudioStreamPlayer::stop()
+{
+    request(STREAM_SOURCE_FILE, nullptr);
+}
+
+StreamStats AudioStreamPlayer::getStats()
+{
+    StreamStats stats;
+    stats.underruns = underruns;
+    stats.overruns = overruns;
+    stats.bufferedSamples = pcmHead.load(std::memory_order_acquire) - pcmTail.load(std::memory_order_acquire);
+    stats.sourceRate = output ? output->getRate() : 0;
+    stats.decodeCpuPercent = decodeCpuPercent;
+    return stats;
+}
+
+uint32_t AudioStreamPlayer::pcmFree() const
+{
+    return STREAM_PCM_RING_SAMPLES - (pcmHead.load(std::memory_order_relaxed) - pcmTail.load(std::memory_order_acquire));
+}
+
+void AudioStreamPlayer::pcmPush(int16_t sample)
+{
+    uint32_t head = pcmHead.load(std::memory_order_relaxed);
+    pcmRing[head & PCM_RING_MASK] = sample;
+    pcmHead.store(head + 1, std::memory_order_release);
+}
+
+void AudioStreamPlayer::mix(int32_t *accumulator, int frames)
+{
+    if (!active)
+    {
+        return;
+    }
+
+    // A new stream started: skip whatever is left of the previous one
+    uint32_t tail = pcmTail.load(std::memory_order_relaxed);
+    uint32_t start = pcmStart.load(std::memory_order_acquire);
+    if ((int32_t)(start - tail) > 0)
+    {
+        tail = start;
+        prebuffering = true;
+    }
+    uint32_t buffered = pcmHead.load(std::memory_order_acquire) - tail;
+
+    // Hold output until the high watermark is reached (stream start or after an underrun).
+    // Once the decoder has finished, drain whatever is left.
+    if (prebuffering)
+    {
+        if (buffered < STREAM_PREBUFFER_HIGH && decoding)
+        {
+            return;
+        }
+        prebuffering = false;
+    }
+
+    uint32_t count = min((uint32_t)frames, buffered);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        accumulator[i] += pcmRing[(tail + i) & PCM_RING_MASK];
+    }
+    pcmTail.store(tail + count, std::memory_order_release);
+
+    if (count < (uint32_t)frames)
+    {
+        if (decoding)
+        {
+            underruns++;
+            prebuffering = true;
+        }
+        else if (buffered == count)
+        {
+            active = false; // Decoder finished and the ring is drained
+        }
+    }
+}
+
+void AudioStreamPlayer::pipelineTaskFunction(void *parameter)
+{
+    static_cast<AudioStreamPlayer *>(parameter)->pipelineLoop();
+}
+
+void AudioStreamPlayer::pipelineLoop()
+{
+    StreamRequest req;
+    int64_t windowStart = esp_timer_get_time();
+    int64_t decodeUs = 0;
+
+    for (;;)
+    {
+        // Idle: sleep until a request arrives. Playing: poll between decode steps.
+        if (xQueueReceive(requestQueue, &req, generator ? 0 : portMAX_DELAY) == pdTRUE)
+        {
+            close();
+            if (req.stop)
+            {
+                active = false;
+            }
+            else if (open(req))
+            {
+                windowStart = esp_timer_get_time();
+                decodeUs = 0;
+            }
+            continue;
+        }
+
+        if (!generator)
+        {
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        bool running = generator->isRunning() && generator->loop();
+        decodeUs += esp_timer_get_time() - start;
+
+        if (!running)
+        {
+            Serial0.printf("📻 Stream finished (%lu underruns, %lu overruns)\n",
+                           (unsigned long)underruns, (unsigned long)overruns);
+            close();
+            continue;
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (now - windowStart >= STREAM_STATS_INTERVAL_MS * 1000LL)
+        {
+            decodeCpuPercent = (100.0f * decodeUs) / (now - windowStart);
+            StreamStats stats = getStats();
+            Serial0.printf("📻 Stream: %lu Hz, %lu ms buffered, decode %.1f%% CPU, %lu underruns, %lu overruns\n",
+                           (unsigned long)stats.sourceRate,
+                           (unsigned long)(stats.bufferedSamples * 1000 / OUTPUT_SAMPLE_RATE),
+                           stats.decodeCpuPercent, (unsigned long)stats.underruns, (unsigned long)stats.overruns);
+            windowStart = now;
+            decodeUs = 0;
+        }
+
+        // Ring full: the decoder is ahead of playback, give the CPU away for a tick
+        if (pcmFree() < STREAM_PCM_RING_SAMPLES / 4)
+        {
+            vTaskDelay(1);
+        }
+    }
+}
+
+bool AudioStreamPlayer::open(const StreamRequest &req)
+{
+    if (req.type == STREAM_SOURCE_HTTP)
+    {
+        wifiPower.beginActivity(); // Modem sleep would starve the source buffer
+        holdingRadio = true;
+        source = new AudioFileSourceHTTPStream(req.path);
+    }
+    else
+    {
+        source = new AudioFileSourceFS(LittleFS, req.path);
+    }
+
+    if (!source || !source->isOpen())
+    {
+        Serial0.printf("❌ Could not open stream source: %s\n", req.path);
+        close();
+        return false;
+    }
+
+    // Compressed data is buffered ahead of the decoder in the preallocated PSRAM buffer
+    bufferedSource = new AudioFileSourceBuffer(source, sourceBuffer, STREAM_SOURCE_BUFFER_BYTES);
+
+    String path(req.path);
+    path.toLowerCase();
+    if (path.endsWith(".aac"))
+    {
+        generator = new AudioGeneratorAAC();
+    }
+    else
+    {
+        generator = new AudioGeneratorMP3();
+    }
+
+    // Output task skips to this point; the ring itself is only ever touched by its owner side
+    pcmStart.store(pcmHead.load(std::memory_order_relaxed), std::memory_order_release);
+    underruns = 0;
+    overruns = 0;
+    decoding = true;
+    active = true;
+
+    if (!generator->begin(bufferedSource, output))
+    {
+        Serial0.printf("❌ Decoder failed to start: %s\n", req.path);
+        close();
+        return false;
+    }
+
+    // Wake the output task so it starts pulling from the PCM ring
+    audioManager.wakeOutput();
+    Serial0.printf("📻 Streaming %s\n", req.path);
+    return true;
+}
+
+void AudioStreamPlayer::close()
+{
+    decoding = false; // Output drains what is buffered, then goes inactive
+    if (generator)
+    {
+        generator->stop();
+        delete generator;
+        generator = nullptr;
+    }
+    if (bufferedSource)
+    {
+        delete bufferedSource;
+        bufferedSource = nullptr;
+    }
+    if (source)
+    {
+        source->close();
+        delete source;
+        source = nullptr;
+    }
+    if (holdingRadio)
+    {
+        wifiPower.endActivity();
+        holdingRadio = false;
+    }
+}
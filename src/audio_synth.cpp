@@ -0,0 +1,231 @@
+#include "audio_synth.h"
+#include <math.h>
+
+#define ENVELOPE_FULL (1 << 24)
+
+// One sine period in Q15 plus a guard point for interpolation
+static int16_t sineTable[SYNTH_WAVETABLE_SIZE + 1];
+static bool sineTableReady = false;
+
+AudioSynth::AudioSynth()
+{
+    memset(voices, 0, sizeof(voices));
+    pendingCount = 0;
+    sampleRate = 16000;
+    clock = 0;
+    noteCounter = 0;
+}
+
+void AudioSynth::init(uint32_t rate)
+{
+    sampleRate = rate;
+
+    if (!sineTableReady)
+    {
+        for (int i = 0; i <= SYNTH_WAVETABLE_SIZE; i++)
+        {
+            sineTable[i] = (int16_t)lrintf(32767.0f * sinf(2.0f * (float)PI * i / SYNTH_WAVETABLE_SIZE));
+        }
+        sineTableReady = true;
+    }
+}
+
+uint32_t AudioSynth::msToFrames(uint32_t ms) const
+{
+    return (ms * sampleRate) / 1000;
+}
+
+bool AudioSynth::schedule(const SynthNote *notes, uint8_t count, const SynthEnvelope &envelope)
+{
+    bool complete = true;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (pendingCount >= SYNTH_MAX_PENDING_NOTES)
+        {
+            complete = false;
+            break;
+        }
+
+        PendingNote &p = pending[pendingCount++];
+        p.note = notes[i];
+        p.envelope = envelope;
+        p.startFrame = clock + msToFrames(notes[i].startMs);
+    }
+
+    return complete;
+}
+
+void AudioSynth::stopAll()
+{
+    pendingCount = 0;
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        Voice &voice = voices[v];
+        if (voice.stage != STAGE_IDLE && voice.stage != STAGE_RELEASE)
+        {
+            voice.gateRemaining = 0;
+        }
+    }
+}
+
+bool AudioSynth::isActive() const
+{
+    if (pendingCount > 0)
+    {
+        return true;
+    }
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (voices[v].stage != STAGE_IDLE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioSynth::startVoice(const PendingNote &p, uint32_t offset)
+{
+    // Free voice, otherwise steal the oldest
+    Voice *voice = &voices[0];
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (voices[v].stage == STAGE_IDLE)
+        {
+            voice = &voices[v];
+            break;
+        }
+        if (voices[v].age < voice->age)
+        {
+            voice = &voices[v];
+        }
+    }
+
+    uint32_t attackFrames = max(msToFrames(p.envelope.attackMs), (uint32_t)1);
+    uint32_t decayFrames = max(msToFrames(p.envelope.decayMs), (uint32_t)1);
+
+    voice->stage = STAGE_ATTACK;
+    voice->waveform = p.note.waveform;
+    voice->phase = 0;
+    voice->phaseInc = (uint32_t)(((uint64_t)p.note.frequency << 32) / sampleRate);
+    voice->gain = (min(p.note.level, (uint8_t)100) * 32767) / 100;
+    voice->level = 0;
+    voice->attackInc = ENVELOPE_FULL / attackFrames;
+    voice->sustainLevel = (int32_t)(((int64_t)ENVELOPE_FULL * min(p.envelope.sustainPercent, (uint8_t)100)) / 100);
+    voice->decayDec = max((ENVELOPE_FULL - voice->sustainLevel) / (int32_t)decayFrames, (int32_t)1);
+    voice->releaseFrames = max(msToFrames(p.envelope.releaseMs), (uint32_t)1);
+    voice->releaseDec = 0;
+    voice->startDelay = offset;
+    voice->gateRemaining = msToFrames(p.note.durationMs);
+    voice->age = ++noteCounter;
+}
+
+void AudioSynth::renderVoice(Voice &voice, int32_t *accumulator, int frames)
+{
+    int i = 0;
+
+    if (voice.startDelay > 0)
+    {
+        uint32_t skip = min(voice.startDelay, (uint32_t)frames);
+        voice.startDelay -= skip;
+        i = skip;
+    }
+
+    for (; i < frames; i++)
+    {
+        // Gate closed: release from the current level
+        if (voice.gateRemaining == 0 && voice.stage != STAGE_RELEASE)
+        {
+            voice.stage = STAGE_RELEASE;
+            voice.releaseDec = max(voice.level / (int32_t)voice.releaseFrames, (int32_t)1);
+        }
+        else if (voice.gateRemaining > 0)
+        {
+            voice.gateRemaining--;
+        }
+
+        switch (voice.stage)
+        {
+        case STAGE_ATTACK:
+            voice.level += voice.attackInc;
+            if (voice.level >= ENVELOPE_FULL)
+            {
+                voice.level = ENVELOPE_FULL;
+                voice.stage = STAGE_DECAY;
+            }
+            break;
+        case STAGE_DECAY:
+            voice.level -= voice.decayDec;
+            if (voice.level <= voice.sustainLevel)
+            {
+                voice.level = voice.sustainLevel;
+                voice.stage = STAGE_SUSTAIN;
+            }
+            break;
+        case STAGE_RELEASE:
+            voice.level -= voice.releaseDec;
+            if (voice.level <= 0)
+            {
+                voice.level = 0;
+                voice.stage = STAGE_IDLE;
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Oscillator (Q15)
+        int32_t sample;
+        if (voice.waveform == WAVE_SQUARE)
+        {
+            sample = (voice.phase & 0x80000000u) ? -16384 : 16384; // -6 dB to match sine loudness
+        }
+        else
+        {
+            uint32_t index = voice.phase >> (32 - SYNTH_WAVETABLE_BITS);
+            int32_t frac = (voice.phase >> (16 - SYNTH_WAVETABLE_BITS)) & 0xFFFF;
+            int32_t a = sineTable[index];
+            int32_t b = sineTable[index + 1];
+            sample = a + (((b - a) * frac) >> 16);
+        }
+        voice.phase += voice.phaseInc;
+
+        // Envelope (Q24 -> Q15) and note level
+        sample = (sample * (voice.level >> 9)) >> 15;
+        accumulator[i] += (sample * voice.gain) >> 15;
+    }
+}
+
+void AudioSynth::mix(int32_t *accumulator, int frames)
+{
+    // Start notes that fall inside this block at their exact frame
+    uint32_t blockEnd = clock + frames;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < pendingCount; i++)
+    {
+        if ((int32_t)(pending[i].startFrame - blockEnd) < 0)
+        {
+            int32_t offset = (int32_t)(pending[i].startFrame - clock);
+            startVoice(pending[i], offset > 0 ? offset : 0);
+        }
+        else
+        {
+            pending[kept++] = pending[i];
+        }
+    }
+    pendingCount = kept;
+
+    for (int v = 0; v < SYNTH_VOICES; v++)
+    {
+        if (voices[v].stage != STAGE_IDLE)
+        {
+            renderVoice(voices[v], accumulator, frames);
+        }
+    }
+
+    clock = blockEnd;
+}
@@ -0,0 +1,92 @@
+#include "audio_vad.h"
+#include <algorithm>
+
+void audio_vad_init(AudioVad &vad)
+{
+    vad.noiseFloorQ8 = VAD_INITIAL_FLOOR << 8;
+    vad.hangover = 0;
+    vad.active = false;
+    vad.blocks = 0;
+    vad.activeBlocks = 0;
+    vad.onsets = 0;
+}
+
+uint16_t audio_vad_zcr(const int16_t *samples, int count)
+{
+    uint16_t crossings = 0;
+    for (int i = 1; i < count; i++)
+    {
+        crossings += (uint16_t)((samples[i - 1] ^ samples[i]) < 0);
+    }
+    return crossings;
+}
+
+bool audio_vad_process(AudioVad &vad, const int16_t *samples, int count, uint16_t rms, bool *onset)
+{
+    uint32_t floor = std::max(vad.noiseFloorQ8 >> 8, (uint32_t)1);
+    uint32_t ratioQ8 = ((uint32_t)rms << 8) / floor;
+
+    // Energy alone for loud events; moderate energy needs a voice-like ZCR.
+    // The ZCR pass is skipped when energy already decides.
+    bool trigger = false;
+    if (rms >= VAD_MIN_RMS)
+    {
+        if (ratioQ8 >= VAD_ONSET_RATIO_Q8)
+        {
+            trigger = true;
+        }
+        else if (ratioQ8 >= VAD_VOICE_RATIO_Q8)
+        {
+            uint16_t zcr = audio_vad_zcr(samples, count);
+            trigger = zcr >= VAD_ZCR_MIN && zcr <= VAD_ZCR_MAX;
+        }
+    }
+
+    // Noise floor: follow drops quickly, rises slowly (~2 s, ~16 s while active so
+    // speech does not pull it up, but a new steady background is still learned)
+    uint32_t rmsQ8 = (uint32_t)rms << 8;
+    if (rmsQ8 < vad.noiseFloorQ8)
+    {
+        vad.noiseFloorQ8 -= (vad.noiseFloorQ8 - rmsQ8) >> 2;
+    }
+    else
+    {
+        vad.noiseFloorQ8 += (rmsQ8 - vad.noiseFloorQ8) >> (trigger ? 10 : 7);
+    }
+    vad.noiseFloorQ8 = std::max(vad.noiseFloorQ8, (uint32_t)(VAD_MIN_RMS << 6));
+
+    bool wasActive = vad.active;
+    if (trigger)
+    {
+        vad.hangover = VAD_HANGOVER_BLOCKS;
+        vad.active = true;
+    }
+    else if (vad.hangover > 0)
+    {
+        vad.hangover--;
+    }
+    else
+    {
+        vad.active = false;
+    }
+
+    *onset = vad.active && !wasActive;
+    vad.blocks++;
+    if (vad.active)
+        vad.activeBlocks++;
+    if (*onset)
+        vad.onsets++;
+
+    return vad.active;
+}
+
+VadStats audio_vad_stats(const AudioVad &vad)
+{
+    VadStats stats;
+    stats.blocks = vad.blocks;
+    stats.activeBlocks = vad.activeBlocks;
+    stats.onsets = vad.onsets;
+    stats.noiseFloor = (uint16_t)(vad.noiseFloorQ8 >> 8);
+    stats.dutyCycle = vad.blocks ? (float)vad.activeBlocks / vad.blocks : 0.0f;
+    return stats;
+}
@@ -0,0 +1,121 @@
+#include "boot_timeline.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct BootStageTiming
+{
+    int64_t startUs; // 0 = not started
+    int64_t endUs;   // 0 = not finished
+    bool skipped;
+    char task[configMAX_TASK_NAME_LEN];    // Task that began the stage
+    char endTask[configMAX_TASK_NAME_LEN]; // Task that ended it
+};
+
+static const char *const stageNames[BOOT_STAGE_COUNT] = {
+    "nvs", "display", "ui", "buttons", "audio", "chime", "wifi", "token", "first poll"};
+
+static BootStageTiming stages[BOOT_STAGE_COUNT];
+
+void boot_stage_begin(BootStage stage)
+{
+    BootStageTiming &timing = stages[stage];
+    strncpy(timing.task, pcTaskGetName(NULL), sizeof(timing.task) - 1);
+    timing.endUs = 0;
+    timing.startUs = esp_timer_get_time();
+}
+
+void boot_stage_end(BootStage stage)
+{
+    BootStageTiming &timing = stages[stage];
+    if (timing.startUs != 0 && timing.endUs == 0)
+    {
+        strncpy(timing.endTask, pcTaskGetName(NULL), sizeof(timing.endTask) - 1);
+        timing.endUs = esp_timer_get_time();
+    }
+}
+
+void boot_stage_skip(BootStage stage)
+{
+    stages[stage].skipped = true;
+}
+
+bool boot_stage_done(BootStage stage)
+{
+    return stages[stage].endUs != 0 || stages[stage].skipped;
+}
+
+bool boot_timeline_complete()
+{
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++)
+    {
+        if (!boot_stage_done((BootStage)i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void boot_timeline_print()
+{
+    // Stages in start order (unstarted ones last)
+    uint8_t order[BOOT_STAGE_COUNT];
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++)
+    {
+        order[i] = i;
+    }
+    for (int i = 1; i < BOOT_STAGE_COUNT; i++)
+    {
+        uint8_t key = order[i];
+        int64_t keyStart = stages[key].startUs ? stages[key].startUs : INT64_MAX;
+        int j = i - 1;
+        while (j >= 0 && (stages[order[j]].startUs ? stages[order[j]].startUs : INT64_MAX) > keyStart)
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+
+    Serial0.println("⏱️ Boot timeline (µs since reset):");
+    Serial0.printf("   %-12s %10s %10s %10s  %s\n", "stage", "start", "end", "duration", "task");
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++)
+    {
+        const BootStageTiming &timing = stages[order[i]];
+        if (timing.skipped)
+        {
+            Serial0.printf("   %-12s %10s\n", stageNames[order[i]], "skipped");
+        }
+        else if (timing.startUs == 0)
+        {
+            Serial0.printf("   %-12s %10s\n", stageNames[order[i]], "-");
+        }
+        else if (timing.endUs == 0)
+        {
+            Serial0.printf("   %-12s %10lld %10s %10s  %s\n", stageNames[order[i]], timing.startUs,
+                           "-", "-", timing.task);
+        }
+        else
+        {
+            bool handedOff = strcmp(timing.task, timing.endTask) != 0;
+            Serial0.printf("   %-12s %10lld %10lld %10lld  %s%s%s\n", stageNames[order[i]], timing.startUs,
+                           timing.endUs, timing.endUs - timing.startUs, timing.task, handedOff ? " -> " : "",
+                           handedOff ? timing.endTask : "");
+        }
+    }
+
+    // The two numbers to watch for regressions
+    if (boot_stage_done(BOOT_STAGE_BUTTONS))
+    {
+        Serial0.printf("⏱️ Interactive at %lld µs\n", stages[BOOT_STAGE_BUTTONS].endUs);
+    }
+    if (boot_stage_done(BOOT_STAGE_FIRST_POLL))
+    {
+        Serial0.printf("⏱️ First poll on screen at %lld µs\n", stages[BOOT_STAGE_FIRST_POLL].endUs);
+    }
+    else
+    {
+        Serial0.println("⏱️ No playback poll finished yet");
+    }
+}
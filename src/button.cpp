@@ -4,245 +4,222 @@
 #include "audio_manager.h"
 #include "lvgl_ui_components.h"
 #include "lvgl_device_screen.h"
-
-// Debounce settings
-#define DEBOUNCE_DELAY 50 // milliseconds
+#include "lvgl_volume_overlay.h"
+#include "button_bindings.h"
+#include "audio_recorder.h"
+#include "wifi_power.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <esp_timer.h>
 
 // Button array
 Button buttons[3] = {
-    {BUTTON_1_PIN, false, false, 0, 0, false, false, 0, 0, 0, false, 0}, // Play/Pause (or Select in device screen)
-    {BUTTON_2_PIN, false, false, 0, 0, false, false, 0, 0, 0, false, 0}, // Next Track (or Down in device screen)
-    {BUTTON_3_PIN, false, false, 0, 0, false, false, 0, 0, 0, false, 0}  // Previous Track (or Up in device screen)
+    {BUTTON_1_PIN, false, false, 0, 0, 0, false, false}, // Play/Pause, hold for devices (Select / hold for back in device screen)
+    {BUTTON_2_PIN, false, false, 0, 0, 0, false, false}, // Next Track, hold for volume up (or Down in device screen)
+    {BUTTON_3_PIN, false, false, 0, 0, 0, false, false}  // Previous Track, hold for volume down (or Up in device screen)
 };
 
-// Track if we've already processed a long press
-static bool longPressProcessed[3] = {false, false, false};
+// Edges from the interrupt handlers, drained by updateButtons()
+static QueueHandle_t buttonEdgeQueue = nullptr;
+static volatile uint32_t droppedEdges = 0;
+static uint32_t handledDroppedEdges = 0;
 
 // Current screen state
 extern UIScreen currentScreen;
 
-void initButtons()
+// Gesture actions
+void gestureOpenDevices(const GestureEvent &event)
 {
-    Serial0.println("Initializing Spotify control buttons...");
+    audioManager.playEarcon(EARCON_SCREEN_ENTER);
+    lvgl_switch_screen(SCREEN_DEVICES);
+}
 
-    // Initialize button pins as input with internal pullup
-    for (int i = 0; i < 3; i++)
-    {
-        pinMode(buttons[i].pin, INPUT_PULLUP);
-        Serial0.printf("Button %d initialized on pin %d\n", i + 1, buttons[i].pin);
-    }
+void gestureOpenSpectrum(const GestureEvent &event)
+{
+    audioManager.playEarcon(EARCON_SCREEN_ENTER);
+    lvgl_switch_screen(SCREEN_SPECTRUM);
+}
 
-    Serial0.println("✅ All buttons initialized with pullup resistors");
+void gestureBackToMain(const GestureEvent &event)
+{
+    audioManager.playEarcon(EARCON_SCREEN_EXIT);
+    lvgl_switch_screen(SCREEN_MAIN);
 }
 
-void updateButtons()
+void gesturePlayPause(const GestureEvent &event) { handlePlayPause(); }
+void gestureNextTrack(const GestureEvent &event) { handleNextTrack(); }
+void gesturePreviousTrack(const GestureEvent &event) { handlePreviousTrack(); }
+void gestureSelectDevice(const GestureEvent &event) { lvgl_select_current_device(); }
+void gestureDeviceDown(const GestureEvent &event) { lvgl_navigate_devices(1); }
+void gestureDeviceUp(const GestureEvent &event) { lvgl_navigate_devices(-1); }
+void gestureVolumeUp(const GestureEvent &event) { lvgl_adjust_volume(1, event.repeat); }
+void gestureVolumeDown(const GestureEvent &event) { lvgl_adjust_volume(-1, event.repeat); }
+
+// Runs on the recorder's encoder task once the recording is flushed
+static void recordingStopped()
 {
-    unsigned long currentTime = millis();
+    audioManager.playEarcon(EARCON_SELECT);
+}
 
-    for (int i = 0; i < 3; i++)
+void gestureToggleRecording(const GestureEvent &event)
+{
+    if (audioRecorder.isRecording())
     {
-        // Read current button state (inverted because of pullup)
-        bool reading = !digitalRead(buttons[i].pin);
+        audioRecorder.stop(recordingStopped); // Returns at once, the earcon confirms the flush
+        return;
+    }
 
-        // Reset wasPressed flag
-        buttons[i].wasPressed = false;
+    char path[RECORD_PATH_MAX];
+    snprintf(path, sizeof(path), "/rec_%lu.wav", (unsigned long)(event.timeMs / 1000));
+    audioManager.playEarcon(audioRecorder.start(path) ? EARCON_CONFIRM : EARCON_ERROR);
+}
 
-        // Debounce logic
-        if (reading != buttons[i].lastState)
-        {
-            buttons[i].lastDebounceTime = currentTime;
-        }
+static uint8_t gestureScreen()
+{
+    return currentScreen;
+}
 
-        if ((currentTime - buttons[i].lastDebounceTime) > DEBOUNCE_DELAY)
-        {
-            if (reading != buttons[i].currentState)
-            {
-                buttons[i].currentState = reading;
-
-                if (buttons[i].currentState) // Button pressed
-                {
-                    buttons[i].isPressed = true;
-                    buttons[i].wasPressed = true;
-                    buttons[i].pressTime = currentTime;
-
-                    // Triple press detection
-                    if (currentTime - buttons[i].lastPressTime > TRIPLE_PRESS_MIN_INTERVAL)
-                    {
-                        if (currentTime - buttons[i].firstPressTime <= TRIPLE_PRESS_WINDOW)
-                        {
-                            buttons[i].pressCount++;
-                        }
-                        else
-                        {
-                            buttons[i].pressCount = 1;
-                            buttons[i].firstPressTime = currentTime;
-                        }
-                        buttons[i].lastPressTime = currentTime;
-
-                        // Set up delayed single press handling
-                        buttons[i].hasPendingSinglePress = true;
-                        buttons[i].pendingSinglePressTime = currentTime;
-                    }
-                }
-                else // Button released
-                {
-                    buttons[i].isPressed = false;
-                }
-            }
-        }
+static uint32_t gestureClockMs()
+{
+    return millis();
+}
 
-        buttons[i].lastState = reading;
-    }
+static void gestureLog(const char *name)
+{
+    Serial0.printf("🔘 Gesture: %s\n", name);
 }
 
-void processPendingSinglePresses()
+static GestureEngine gestureEngine;
+
+// Runs on every edge of a button pin; only timestamps and queues it
+static void IRAM_ATTR buttonEdgeIsr(void *arg)
 {
-    unsigned long currentTime = millis();
+    uint8_t index = (uint8_t)(uintptr_t)arg;
+    ButtonEdge edge = {esp_timer_get_time(), index, digitalRead(buttons[index].pin) == LOW};
 
-    for (int i = 0; i < 3; i++)
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(buttonEdgeQueue, &edge, &woken) != pdTRUE)
     {
-        if (buttons[i].hasPendingSinglePress)
-        {
-            // Check if triple press window has expired
-            if ((currentTime - buttons[i].pendingSinglePressTime) > TRIPLE_PRESS_WINDOW)
-            {
-                // If we didn't get a triple press, process the single press
-                if (buttons[i].pressCount < 3)
-                {
-                    Serial0.printf("🔘 Processing delayed single press for button %d\n", i + 1);
-
-                    if (currentScreen == SCREEN_MAIN)
-                    {
-                        switch (i)
-                        {
-                        case 0: // Button 1 - Play/Pause
-                            handlePlayPause();
-                            break;
-                        case 1: // Button 2 - Next Track
-                            handleNextTrack();
-                            break;
-                        case 2: // Button 3 - Previous Track
-                            handlePreviousTrack();
-                            break;
-                        }
-                    }
-                    else if (currentScreen == SCREEN_DEVICES)
-                    {
-                        switch (i)
-                        {
-                        case 0: // Button 1 - Select device
-                            lvgl_select_current_device();
-                            break;
-                        case 1: // Button 2 - Down
-                            lvgl_navigate_devices(1);
-                            break;
-                        case 2: // Button 3 - Up
-                            lvgl_navigate_devices(-1);
-                            break;
-                        }
-                    }
-                }
-
-                // Clear pending state
-                buttons[i].hasPendingSinglePress = false;
-                buttons[i].pressCount = 0;
-                buttons[i].firstPressTime = 0;
-            }
-        }
+        droppedEdges++;
+    }
+    if (woken)
+    {
+        portYIELD_FROM_ISR();
     }
 }
 
-bool isButtonTriplePressed(uint8_t buttonIndex)
+void initButtons()
 {
-    if (buttonIndex >= 3)
-        return false;
+    Serial0.println("Initializing Spotify control buttons...");
 
-    // Check if we have 3 presses within the time window
-    if (buttons[buttonIndex].pressCount >= 3)
+    buttonEdgeQueue = xQueueCreate(BUTTON_EDGE_QUEUE_LEN, sizeof(ButtonEdge));
+    if (!buttonEdgeQueue)
     {
-        unsigned long currentTime = millis();
-        if (currentTime - buttons[buttonIndex].firstPressTime <= TRIPLE_PRESS_WINDOW)
-        {
-            // Clear pending single press since we got a triple press
-            buttons[buttonIndex].hasPendingSinglePress = false;
+        Serial0.println("❌ Failed to create button edge queue");
+        return;
+    }
 
-            // Reset the counter to prevent multiple triggers
-            buttons[buttonIndex].pressCount = 0;
-            buttons[buttonIndex].firstPressTime = 0;
-            return true;
-        }
-        else
-        {
-            // Reset if window expired
-            buttons[buttonIndex].pressCount = 0;
-            buttons[buttonIndex].firstPressTime = 0;
-        }
+    // Initialize button pins as input with internal pullup, interrupt on both edges
+    for (int i = 0; i < 3; i++)
+    {
+        pinMode(buttons[i].pin, INPUT_PULLUP);
+        buttons[i].currentState = buttons[i].lastState = !digitalRead(buttons[i].pin);
+        attachInterruptArg(buttons[i].pin, buttonEdgeIsr, (void *)(uintptr_t)i, CHANGE);
+        Serial0.printf("Button %d initialized on pin %d\n", i + 1, buttons[i].pin);
     }
-    return false;
-}
 
-bool isButtonLongPressed(uint8_t buttonIndex)
-{
-    // Keep this function for compatibility but not used for screen switching
-    return false;
+    gesture_init(gestureEngine, gestureBindings, GESTURE_BINDING_COUNT, gestureScreen, gestureClockMs, gestureLog);
+
+    Serial0.println("✅ All buttons initialized with pullup resistors and edge interrupts");
 }
 
-void handleSpotifyControls()
+// A debounced press or release, at the time the edge happened (not when the loop saw it)
+static void acceptTransition(int i, bool pressed, int64_t timeUs)
 {
-    // Handle button presses based on current screen
-    if (currentScreen == SCREEN_MAIN)
+    buttons[i].currentState = pressed;
+    buttons[i].lastAcceptedUs = timeUs;
+
+    if (!pressed) // Button released
     {
-        handleMainScreenButtons();
+        buttons[i].isPressed = false;
+        gesture_input(gestureEngine, i, false, (uint32_t)(timeUs / 1000));
+        return;
     }
-    else if (currentScreen == SCREEN_DEVICES)
+
+    // Any press may lead to a Spotify command: leave modem sleep before the gesture resolves
+    wifiPower.wake(WIFI_WAKE_INPUT);
+
+    uint32_t currentTime = (uint32_t)(timeUs / 1000); // Same clock as millis()
+    buttons[i].isPressed = true;
+    buttons[i].wasPressed = true;
+    buttons[i].pressTime = currentTime;
+
+    uint32_t lateMs = millis() - currentTime;
+    if (lateMs > BUTTON_LATE_DISPATCH_MS)
     {
-        handleDeviceScreenButtons();
+        Serial0.printf("🔘 Button %d press picked up %lu ms after the edge (loop was busy)\n", i + 1, (unsigned long)lateMs);
     }
 
-    // Process any pending single presses
-    processPendingSinglePresses();
+    gesture_input(gestureEngine, i, true, currentTime);
 }
 
-void handleMainScreenButtons()
+void updateButtons()
 {
-    // Check for triple press on any button to enter device screen
+    if (!buttonEdgeQueue)
+    {
+        return;
+    }
+
     for (int i = 0; i < 3; i++)
     {
-        if (isButtonTriplePressed(i))
+        // Reset wasPressed flag
+        buttons[i].wasPressed = false;
+    }
+
+    // Replay queued edges in order; presses made during a blocking call are not lost
+    ButtonEdge edge;
+    while (xQueueReceive(buttonEdgeQueue, &edge, 0) == pdTRUE)
+    {
+        Button &button = buttons[edge.button];
+        button.lastState = edge.pressed;
+        button.lastEdgeUs = edge.timeUs;
+
+        // Leading-edge debounce: the first edge acts at once, the bounce after it is ignored
+        if (edge.pressed != button.currentState &&
+            edge.timeUs - button.lastAcceptedUs >= BUTTON_DEBOUNCE_LOCKOUT_US)
         {
-            Serial0.printf("Triple press detected on button %d - switching to device screen\n", i + 1);
-            audioManager.playBeep(1000, 100);
-            delay(50);
-            audioManager.playBeep(1200, 100);
-            delay(50);
-            audioManager.playBeep(1400, 100);
-            lvgl_switch_screen(SCREEN_DEVICES);
-            return;
+            acceptTransition(edge.button, edge.pressed, edge.timeUs);
         }
     }
 
-    // Single press handling is now done in processPendingSinglePresses()
-}
+    // Lost edges (full queue): trust the pins again
+    uint32_t dropped = droppedEdges;
+    if (dropped != handledDroppedEdges)
+    {
+        Serial0.printf("⚠️ Button edge queue overflowed (%lu edges dropped)\n", (unsigned long)(dropped - handledDroppedEdges));
+        handledDroppedEdges = dropped;
+        for (int i = 0; i < 3; i++)
+        {
+            buttons[i].lastState = !digitalRead(buttons[i].pin);
+        }
+    }
 
-void handleDeviceScreenButtons()
-{
-    // Check for triple press to return to main screen
+    // A bounce that settles inside the lockout leaves its final level unaccepted
+    int64_t now = esp_timer_get_time();
     for (int i = 0; i < 3; i++)
     {
-        if (isButtonTriplePressed(i))
+        int64_t lockoutEnd = buttons[i].lastAcceptedUs + BUTTON_DEBOUNCE_LOCKOUT_US;
+        if (buttons[i].lastState != buttons[i].currentState && now >= lockoutEnd)
         {
-            Serial0.printf("Triple press detected on button %d - returning to main screen\n", i + 1);
-            audioManager.playBeep(800, 100);
-            delay(50);
-            audioManager.playBeep(600, 100);
-            delay(50);
-            audioManager.playBeep(400, 100);
-            lvgl_switch_screen(SCREEN_MAIN);
-            return;
+            acceptTransition(i, buttons[i].lastState, max(buttons[i].lastEdgeUs, lockoutEnd));
         }
     }
+}
 
-    // Single press handling is now done in processPendingSinglePresses()
+void handleSpotifyControls()
+{
+    // Long presses, repeats and tap windows resolve on time, not on edges
+    gesture_poll(gestureEngine);
 }
 
 void handlePlayPause()
@@ -250,7 +227,7 @@ void handlePlayPause()
     Serial0.println("=== PLAY/PAUSE BUTTON PRESSED ===");
 
     // Play audio feedback
-    audioManager.playBeep(800, 150);
+    audioManager.playEarcon(EARCON_PLAY_PAUSE);
 
     // Get current track to check if playing
     SpotifyTrack currentTrack;
@@ -284,9 +261,7 @@ void handleNextTrack()
     Serial0.println("=== NEXT TRACK BUTTON PRESSED ===");
 
     // Play audio feedback - two quick beeps
-    audioManager.playBeep(1000, 100);
-    delay(50);
-    audioManager.playBeep(1200, 100);
+    audioManager.playEarcon(EARCON_NEXT);
 
     Serial0.println("Action: Skipping to next track");
     spotifyManager.next();
@@ -302,9 +277,7 @@ void handlePreviousTrack()
     Serial0.println("=== PREVIOUS TRACK BUTTON PRESSED ===");
 
     // Play audio feedback - two quick low beeps
-    audioManager.playBeep(600, 100);
-    delay(50);
-    audioManager.playBeep(500, 100);
+    audioManager.playEarcon(EARCON_PREVIOUS);
 
     Serial0.println("Action: Going to previous track");
     spotifyManager.previous();
@@ -0,0 +1,267 @@
+#include "button_gestures.h"
+#include <string.h>
+
+enum GesturePhase : uint8_t
+{
+    PHASE_IDLE,
+    PHASE_PRESSED,     // Held, nothing fired yet
+    PHASE_WAIT_DOUBLE, // Released, a second press would make a double
+    PHASE_REPEATING,   // Hold-repeat running
+    PHASE_CONSUMED     // A gesture already used this press; ignore until release
+};
+
+// Signed difference, safe across millis() wrap
+static inline int32_t elapsed(uint32_t now, uint32_t since)
+{
+    return (int32_t)(now - since);
+}
+
+static const GestureBinding *find_binding(const GestureEngine &engine, GestureType type, uint8_t buttons)
+{
+    for (uint8_t i = 0; i < engine.bindingCount; i++)
+    {
+        const GestureBinding &binding = engine.bindings[i];
+        if (binding.screen == engine.screen && binding.type == type && binding.buttons == buttons)
+        {
+            return &binding;
+        }
+    }
+    return nullptr;
+}
+
+// Mask of buttons that form a chord with this one on the current screen
+static uint8_t chord_partners(const GestureEngine &engine, uint8_t button)
+{
+    uint8_t partners = 0;
+    for (uint8_t i = 0; i < engine.bindingCount; i++)
+    {
+        const GestureBinding &binding = engine.bindings[i];
+        if (binding.screen == engine.screen && binding.type == GESTURE_CHORD &&
+            (binding.buttons & GESTURE_BUTTON(button)))
+        {
+            partners |= binding.buttons & ~GESTURE_BUTTON(button);
+        }
+    }
+    return partners;
+}
+
+static void fire(GestureEngine &engine, const GestureBinding *binding, uint16_t repeat, uint32_t timeMs)
+{
+    if (!binding)
+        return;
+
+    GestureEvent event = {binding->type, binding->buttons, repeat, timeMs};
+    engine.gesturesFired++;
+    if (repeat == 0 && engine.logger)
+    {
+        engine.logger(binding->name);
+    }
+    binding->action(event);
+}
+
+// Screen changed under us (usually by the gesture just fired): gestures in
+// flight belong to the old screen, so held buttons are spent until released
+static void sync_screen(GestureEngine &engine)
+{
+    uint8_t screen = engine.screenProvider ? engine.screenProvider() : 0;
+    if (screen == engine.screen)
+        return;
+
+    engine.screen = screen;
+    for (int b = 0; b < GESTURE_MAX_BUTTONS; b++)
+    {
+        GestureButton &state = engine.buttons[b];
+        state.phase = (state.phase == PHASE_IDLE || state.phase == PHASE_WAIT_DOUBLE) ? PHASE_IDLE : PHASE_CONSUMED;
+    }
+}
+
+// Resolve one button at time nowMs: fire whatever can no longer be contested
+static void resolve(GestureEngine &engine, uint8_t b, uint32_t nowMs)
+{
+    sync_screen(engine);
+    GestureButton &state = engine.buttons[b];
+    uint8_t mask = GESTURE_BUTTON(b);
+
+    switch (state.phase)
+    {
+    case PHASE_PRESSED:
+    {
+        // A partner may still complete a chord
+        if (chord_partners(engine, b) && elapsed(nowMs, state.pressMs) < GESTURE_CHORD_WINDOW_MS)
+            return;
+
+        // Hold-repeat starts on press, or at the long press threshold when a tap is also bound
+        const GestureBinding *repeat = find_binding(engine, GESTURE_HOLD_REPEAT, mask);
+        if (repeat)
+        {
+            uint32_t startMs = state.pressMs;
+            uint32_t firstRepeatMs = GESTURE_REPEAT_DELAY_MS;
+            if (find_binding(engine, GESTURE_SINGLE, mask))
+            {
+                startMs += GESTURE_LONG_PRESS_MS;
+                firstRepeatMs = GESTURE_REPEAT_INTERVAL_MS; // The hold itself was the delay
+                if (elapsed(nowMs, startMs) < 0)
+                    return; // Otherwise the release decides
+            }
+
+            state.phase = PHASE_REPEATING;
+            state.repeat = 0;
+            state.nextRepeatMs = startMs + firstRepeatMs;
+            fire(engine, repeat, 0, startMs);
+            resolve(engine, b, nowMs); // Catch up on repeats due since startMs
+            return;
+        }
+
+        const GestureBinding *longPress = find_binding(engine, GESTURE_LONG, mask);
+        if (longPress)
+        {
+            if (elapsed(nowMs, state.pressMs) >= GESTURE_LONG_PRESS_MS)
+            {
+                state.phase = PHASE_CONSUMED;
+                fire(engine, longPress, 0, state.pressMs + GESTURE_LONG_PRESS_MS);
+            }
+            return; // Otherwise the release decides
+        }
+
+        if (find_binding(engine, GESTURE_DOUBLE, mask))
+            return; // The release decides
+
+        // Nothing competes: act on the press itself
+        state.phase = PHASE_CONSUMED;
+        fire(engine, find_binding(engine, GESTURE_SINGLE, mask), 0, nowMs);
+        return;
+    }
+
+    case PHASE_WAIT_DOUBLE:
+        if (elapsed(nowMs, state.releaseMs) > GESTURE_DOUBLE_WINDOW_MS)
+        {
+            state.phase = PHASE_IDLE;
+            fire(engine, find_binding(engine, GESTURE_SINGLE, mask), 0, state.releaseMs + GESTURE_DOUBLE_WINDOW_MS);
+        }
+        return;
+
+    case PHASE_REPEATING:
+        while (state.phase == PHASE_REPEATING && elapsed(nowMs, state.nextRepeatMs) >= 0)
+        {
+            uint32_t repeatMs = state.nextRepeatMs;
+            state.repeat++;
+            state.nextRepeatMs += GESTURE_REPEAT_INTERVAL_MS;
+            fire(engine, find_binding(engine, GESTURE_HOLD_REPEAT, mask), state.repeat, repeatMs);
+            sync_screen(engine);
+        }
+        return;
+
+    default:
+        return;
+    }
+}
+
+void gesture_init(GestureEngine &engine, const GestureBinding *bindings, uint8_t bindingCount,
+                  uint8_t (*screenProvider)(), uint32_t (*clockMs)(), void (*logger)(const char *name))
+{
+    memset(&engine, 0, sizeof(engine));
+    engine.bindings = bindings;
+    engine.bindingCount = bindingCount;
+    engine.screenProvider = screenProvider;
+    engine.clockMs = clockMs;
+    engine.logger = logger;
+    engine.screen = screenProvider ? screenProvider() : 0;
+}
+
+void gesture_tick(GestureEngine &engine, uint32_t nowMs)
+{
+    for (uint8_t b = 0; b < GESTURE_MAX_BUTTONS; b++)
+    {
+        resolve(engine, b, nowMs);
+    }
+}
+
+void gesture_poll(GestureEngine &engine)
+{
+    if (engine.clockMs)
+    {
+        gesture_tick(engine, engine.clockMs());
+    }
+}
+
+static void press(GestureEngine &engine, uint8_t b, uint32_t timeMs)
+{
+    GestureButton &state = engine.buttons[b];
+    uint8_t mask = GESTURE_BUTTON(b);
+
+    // Second button of a chord: the partner is still undecided inside the window
+    uint8_t partners = chord_partners(engine, b);
+    for (uint8_t p = 0; p < GESTURE_MAX_BUTTONS; p++)
+    {
+        GestureButton &partner = engine.buttons[p];
+        if ((partners & GESTURE_BUTTON(p)) && partner.phase == PHASE_PRESSED &&
+            elapsed(timeMs, partner.pressMs) <= GESTURE_CHORD_WINDOW_MS)
+        {
+            partner.phase = PHASE_CONSUMED;
+            state.phase = PHASE_CONSUMED;
+            fire(engine, find_binding(engine, GESTURE_CHORD, mask | GESTURE_BUTTON(p)), 0, timeMs);
+            return;
+        }
+    }
+
+    if (state.phase == PHASE_WAIT_DOUBLE)
+    {
+        state.phase = PHASE_CONSUMED;
+        fire(engine, find_binding(engine, GESTURE_DOUBLE, mask), 0, timeMs);
+        return;
+    }
+
+    state.phase = PHASE_PRESSED;
+    state.pressMs = timeMs;
+    resolve(engine, b, timeMs);
+}
+
+static void release(GestureEngine &engine, uint8_t b, uint32_t timeMs)
+{
+    GestureButton &state = engine.buttons[b];
+    uint8_t mask = GESTURE_BUTTON(b);
+
+    if (state.phase != PHASE_PRESSED)
+    {
+        state.phase = PHASE_IDLE;
+        return;
+    }
+
+    // Released before long press / chord resolved: it was a tap
+    const GestureBinding *repeat = find_binding(engine, GESTURE_HOLD_REPEAT, mask);
+    if (repeat && !find_binding(engine, GESTURE_SINGLE, mask))
+    {
+        state.phase = PHASE_IDLE;
+        fire(engine, repeat, 0, timeMs);
+        return;
+    }
+
+    if (find_binding(engine, GESTURE_DOUBLE, mask))
+    {
+        state.phase = PHASE_WAIT_DOUBLE;
+        state.releaseMs = timeMs;
+        return;
+    }
+
+    state.phase = PHASE_IDLE;
+    fire(engine, find_binding(engine, GESTURE_SINGLE, mask), 0, timeMs);
+}
+
+void gesture_input(GestureEngine &engine, uint8_t button, bool pressed, uint32_t timeMs)
+{
+    if (button >= GESTURE_MAX_BUTTONS)
+        return;
+
+    // Timeouts that expired before this edge happened come first
+    gesture_tick(engine, timeMs);
+    sync_screen(engine);
+
+    if (pressed)
+    {
+        press(engine, button, timeMs);
+    }
+    else
+    {
+        release(engine, button, timeMs);
+    }
+}
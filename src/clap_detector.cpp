@@ -0,0 +1,116 @@
+#include "clap_detector.h"
+#include "audio_manager.h"
+#include "audio_stream_player.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+ClapDetector clapDetector;
+
+ClapDetector::ClapDetector()
+{
+    onset_init(detector);
+    reader = {0, 0};
+    power = nullptr;
+    task = nullptr;
+    pending.store(CLAP_NONE);
+    enabled_ = true;
+    outputGuardUntilUs = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool ClapDetector::init()
+{
+    power = (uint32_t *)heap_caps_malloc(AUDIO_FFT_BINS * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!power)
+    {
+        Serial0.println("❌ Failed to allocate clap detector buffers");
+        return false;
+    }
+
+    audioManager.getCaptureRing().attachReader(reader);
+    if (xTaskCreatePinnedToCore(taskFunction, "ClapDetect", CLAP_TASK_STACK, this,
+                                CLAP_TASK_PRIORITY, &task, CLAP_TASK_CORE) != pdPASS)
+    {
+        Serial0.println("❌ Failed to start clap detector task");
+        return false;
+    }
+
+    Serial0.println("👏 Clap detector running (double = play/pause, triple = next)");
+    return true;
+}
+
+void ClapDetector::taskFunction(void *parameter)
+{
+    static_cast<ClapDetector *>(parameter)->taskLoop();
+}
+
+void ClapDetector::taskLoop()
+{
+    AudioRingBuffer &ring = audioManager.getCaptureRing();
+    int64_t windowStart = esp_timer_get_time();
+    int64_t busyUs = 0;
+
+    for (;;)
+    {
+        const AudioBlock *block = ring.peek(reader);
+        if (!block)
+        {
+            vTaskDelay(pdMS_TO_TICKS(8)); // Half a capture block
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+
+        // The speaker is picked up by the mic: no detection while it plays
+        if (audioManager.isPlaying() || audioStreamPlayer.isActive())
+        {
+            outputGuardUntilUs = start + CLAP_OUTPUT_GUARD_MS * 1000LL;
+        }
+
+        bool onset = false;
+        ClapPattern pattern = CLAP_NONE;
+        if (enabled_)
+        {
+            pattern = onset_process_block(detector, block->samples, block->flags & AUDIO_BLOCK_ACTIVE,
+                                          block->timestampUs, power, &onset);
+        }
+        int64_t blockTimestamp = block->timestampUs;
+        ring.release(reader);
+
+        if (onset)
+        {
+            if (start < outputGuardUntilUs)
+            {
+                // Forget the partial pattern so speaker audio cannot complete one
+                stats.suppressed++;
+                detector.clapCount = 0;
+                pattern = CLAP_NONE;
+            }
+            else
+            {
+                stats.onsets++;
+                uint32_t latency = (uint32_t)(esp_timer_get_time() - blockTimestamp);
+                stats.maxLatencyUs = max(stats.maxLatencyUs, latency);
+                Serial0.printf("👏 Onset (%lu us after capture)\n", (unsigned long)latency);
+            }
+        }
+
+        if (pattern != CLAP_NONE)
+        {
+            stats.patterns++;
+            pending.store(pattern);
+        }
+
+        int64_t now = esp_timer_get_time();
+        busyUs += now - start;
+        if (now - windowStart >= CLAP_STATS_INTERVAL_MS * 1000LL)
+        {
+            stats.cpuPercent = (100.0f * busyUs) / (now - windowStart);
+            Serial0.printf("👏 Clap detector: %.2f%% CPU, %lu onsets, %lu patterns, %lu suppressed, max latency %lu us\n",
+                           stats.cpuPercent, (unsigned long)stats.onsets, (unsigned long)stats.patterns,
+                           (unsigned long)stats.suppressed, (unsigned long)stats.maxLatencyUs);
+            windowStart = now;
+            busyUs = 0;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include "ima_adpcm.h"
+
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767};
+
+static const int8_t indexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8};
+
+void ima_adpcm_reset(ImaAdpcmState &state)
+{
+    state.predictor = 0;
+    state.stepIndex = 0;
+}
+
+int16_t ima_adpcm_decode_nibble(ImaAdpcmState &state, uint8_t nibble)
+{
+    int32_t step = stepTable[state.stepIndex];
+    int32_t diff = step >> 3;
+    if (nibble & 4)
+        diff += step;
+    if (nibble & 2)
+        diff += step >> 1;
+    if (nibble & 1)
+        diff += step >> 2;
+
+    int32_t predictor = state.predictor + ((nibble & 8) ? -diff : diff);
+    state.predictor = (int16_t)constrain(predictor, -32768, 32767);
+
+    int index = state.stepIndex + indexTable[nibble & 0x0F];
+    state.stepIndex = (uint8_t)constrain(index, 0, 88);
+
+    return state.predictor;
+}
+
+uint8_t ima_adpcm_encode_sample(ImaAdpcmState &state, int16_t sample)
+{
+    int32_t step = stepTable[state.stepIndex];
+    int32_t diff = sample - state.predictor;
+    uint8_t nibble = 0;
+    if (diff < 0)
+    {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    // Successive approximation, mirroring the decoder's reconstruction
+    if (diff >= step)
+    {
+        nibble |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        nibble |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step)
+    {
+        nibble |= 1;
+    }
+
+    ima_adpcm_decode_nibble(state, nibble);
+    return nibble;
+}
+
+void ima_adpcm_encode_block(ImaAdpcmState &state, const int16_t *samples, uint8_t *block)
+{
+    // Header: first sample verbatim (little endian), step index, reserved
+    state.predictor = samples[0];
+    block[0] = (uint8_t)(samples[0] & 0xFF);
+    block[1] = (uint8_t)((uint16_t)samples[0] >> 8);
+    block[2] = state.stepIndex;
+    block[3] = 0;
+
+    uint8_t *out = block + 4;
+    for (int i = 1; i < IMA_ADPCM_SAMPLES_PER_BLOCK; i += 2)
+    {
+        uint8_t low = ima_adpcm_encode_sample(state, samples[i]);
+        uint8_t high = ima_adpcm_encode_sample(state, samples[i + 1]);
+        *out++ = low | (high << 4);
+    }
+}
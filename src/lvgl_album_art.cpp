@@ -1,6 +1,8 @@
 #include "lvgl_album_art.h"
 #include "lvgl_ui_components.h"
+#include "wifi_power.h"
 #include <Arduino.h>
+#include <atomic>
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <TJpg_Decoder.h>
@@ -20,6 +22,17 @@ static uint16_t temp_height = 0;
 static TaskHandle_t imageDownloadTask = NULL;
 static String pendingImageUrl = "";
 
+// The download task keeps WiFi out of power save: taken when the task is started,
+// released by whoever ends it
+static std::atomic<bool> downloadHoldsRadio(false);
+
+static void releaseDownloadRadio()
+{
+    if (downloadHoldsRadio.exchange(false)) {
+        wifiPower.endActivity();
+    }
+}
+
 // Thread-safe communication between download task and main thread
 static bool imageReadyForDisplay = false;
 static uint8_t* downloadedImageData = nullptr;
@@ -53,6 +66,7 @@ void lvgl_download_and_set_album_art(const String& imageUrl)
     
     Serial0.println("📷 Downloading album artwork from: " + imageUrl);
     
+    WiFiActivity radio;
     HTTPClient http;
     http.begin(imageUrl);
     http.setTimeout(15000); // 15 second timeout for larger images
@@ -337,6 +351,7 @@ void imageDownloadTaskFunction(void* parameter)
     WiFiClientSecure *client = new WiFiClientSecure;
     if (!client) {
         Serial0.println("❌ Background task: Failed to create SSL client");
+        releaseDownloadRadio();
         imageDownloadTask = NULL;
         vTaskDelete(NULL);
         return;
@@ -395,6 +410,7 @@ void imageDownloadTaskFunction(void* parameter)
     
     http.end();
     delete client; // Clean up SSL client
+    releaseDownloadRadio();
     
     // Task will delete itself when function exits
     imageDownloadTask = NULL;
@@ -415,6 +431,7 @@ void lvgl_lazy_load_album_art(const String& imageUrl)
         Serial0.println("🛑 Cancelling previous image download task");
         vTaskDelete(imageDownloadTask);
         imageDownloadTask = NULL;
+        releaseDownloadRadio();
     }
     
     // Create a copy of the URL string for the task
@@ -422,7 +439,12 @@ void lvgl_lazy_load_album_art(const String& imageUrl)
     
     // Start download in background task (truly non-blocking)
     Serial0.printf("🚀 Starting async album artwork download (Free heap: %d bytes)...\n", esp_get_free_heap_size());
-    xTaskCreatePinnedToCore(
+
+    // Taken here rather than in the task: the cancel above runs on this thread,
+    // so it can never fall between the task taking the hold and flagging it
+    downloadHoldsRadio = true;
+    wifiPower.beginActivity();
+    BaseType_t created = xTaskCreatePinnedToCore(
         imageDownloadTaskFunction,  // Task function
         "ImageDownload",            // Task name
         12288,                      // Stack size (12KB - increased for SSL)
@@ -431,6 +453,12 @@ void lvgl_lazy_load_album_art(const String& imageUrl)
         &imageDownloadTask,         // Task handle
         0                           // Core (use core 0, main loop uses core 1)
     );
+    if (created != pdPASS) {
+        Serial0.println("❌ Failed to start image download task");
+        imageDownloadTask = NULL;
+        delete urlCopy;
+        releaseDownloadRadio();
+    }
 }
 
 // Check for completed image downloads and process them (call from main loop)
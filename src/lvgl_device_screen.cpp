@@ -3,18 +3,195 @@
 #include "spotify_manager.h"
 #include "audio_manager.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 
 // Device screen objects
 lv_obj_t *device_screen;
 lv_obj_t *device_title_label;
 lv_obj_t *device_list_container;
 lv_obj_t *device_instruction_label;
+lv_obj_t *device_position_label;
 
-// Device data
-static SpotifyDevice currentDevices[10];
+// Device data (sized by whatever the account reports)
+static std::vector<SpotifyDevice> currentDevices;
 static int currentDeviceCount = 0;
 static int selectedDeviceIndex = 0;
 
+// First device index shown in the visible window
+static int windowTop = 0;
+
+// Device cache generation currently rendered
+static uint32_t renderedCacheGeneration = 0;
+
+// Row visual states (each maps to one shared style)
+enum DeviceRowState
+{
+    ROW_HIDDEN = 0,
+    ROW_NORMAL,
+    ROW_ACTIVE,
+    ROW_SELECTED
+};
+
+// Persistent row objects, created once and rebound to whichever device
+// currently scrolls into their slot
+struct DeviceRow
+{
+    lv_obj_t *label;
+    DeviceRowState state;
+    char text[96];
+};
+
+static DeviceRow deviceRows[DEVICE_LIST_VISIBLE_ROWS];
+
+// Shared row styles
+static lv_style_t style_row_base;
+static lv_style_t style_row_normal;
+static lv_style_t style_row_active;
+static lv_style_t style_row_selected;
+
+static lv_style_t *style_for_state(DeviceRowState state)
+{
+    switch (state)
+    {
+    case ROW_ACTIVE:
+        return &style_row_active;
+    case ROW_SELECTED:
+        return &style_row_selected;
+    default:
+        return &style_row_normal;
+    }
+}
+
+static void init_row_styles()
+{
+    lv_style_init(&style_row_base);
+    lv_style_set_text_font(&style_row_base, &lv_font_montserrat_12);
+    lv_style_set_width(&style_row_base, 280);
+
+    lv_style_init(&style_row_normal);
+    lv_style_set_text_color(&style_row_normal, lv_color_hex(0xcccccc));
+
+    lv_style_init(&style_row_active);
+    lv_style_set_text_color(&style_row_active, lv_color_hex(0x4fc3f7));
+
+    lv_style_init(&style_row_selected);
+    lv_style_set_text_color(&style_row_selected, lv_color_hex(0x1db954));
+    lv_style_set_bg_color(&style_row_selected, lv_color_hex(0x2a2a2a));
+    lv_style_set_bg_opa(&style_row_selected, LV_OPA_50);
+}
+
+static void create_device_rows()
+{
+    for (int i = 0; i < DEVICE_LIST_VISIBLE_ROWS; i++)
+    {
+        DeviceRow &row = deviceRows[i];
+        row.label = lv_label_create(device_list_container);
+        lv_obj_add_style(row.label, &style_row_base, 0);
+        lv_obj_add_style(row.label, &style_row_normal, 0);
+        lv_obj_set_pos(row.label, 10, DEVICE_LIST_TOP_PAD + (i * DEVICE_LIST_ROW_PITCH));
+        lv_label_set_long_mode(row.label, LV_LABEL_LONG_DOT);
+        lv_label_set_text_static(row.label, "");
+        lv_obj_add_flag(row.label, LV_OBJ_FLAG_HIDDEN);
+        row.state = ROW_HIDDEN;
+        row.text[0] = '\0';
+    }
+}
+
+// Scroll the window so the selection is visible; returns true if it moved
+static bool scroll_to_selection()
+{
+    int oldTop = windowTop;
+
+    if (selectedDeviceIndex < windowTop)
+    {
+        windowTop = selectedDeviceIndex;
+    }
+    else if (selectedDeviceIndex >= windowTop + DEVICE_LIST_VISIBLE_ROWS)
+    {
+        windowTop = selectedDeviceIndex - DEVICE_LIST_VISIBLE_ROWS + 1;
+    }
+
+    int maxTop = max(0, currentDeviceCount - DEVICE_LIST_VISIBLE_ROWS);
+    windowTop = constrain(windowTop, 0, maxTop);
+    return windowTop != oldTop;
+}
+
+static void update_position_label()
+{
+    char text[16];
+    if (currentDeviceCount > 0)
+    {
+        snprintf(text, sizeof(text), "%d/%d", selectedDeviceIndex + 1, currentDeviceCount);
+    }
+    else
+    {
+        text[0] = '\0';
+    }
+    lv_label_set_text(device_position_label, text);
+}
+
+// Rewrite a row slot only where its text or state differs from what is displayed
+static void render_device_row(int slot)
+{
+    DeviceRow &row = deviceRows[slot];
+    int i = windowTop + slot;
+
+    if (i >= currentDeviceCount)
+    {
+        if (row.state != ROW_HIDDEN)
+        {
+            lv_obj_add_flag(row.label, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_remove_style(row.label, style_for_state(row.state), 0);
+            lv_obj_add_style(row.label, &style_row_normal, 0);
+            row.state = ROW_HIDDEN;
+        }
+        return;
+    }
+
+    const SpotifyDevice &device = currentDevices[i];
+    bool selected = (i == selectedDeviceIndex);
+
+    // Format device text
+    char text[sizeof(row.text)];
+    int len = snprintf(text, sizeof(text), "%s%s%s (%s)",
+                       selected ? "► " : "  ",
+                       device.name.c_str(),
+                       device.isActive ? " ✓" : "",
+                       device.type.c_str());
+    if (device.volumePercent > 0 && len < (int)sizeof(text))
+    {
+        snprintf(text + len, sizeof(text) - len, " %d%%", device.volumePercent);
+    }
+
+    if (strcmp(row.text, text) != 0)
+    {
+        strlcpy(row.text, text, sizeof(row.text));
+        lv_label_set_text(row.label, row.text);
+    }
+
+    // Style based on selection and active state
+    DeviceRowState state = selected ? ROW_SELECTED : (device.isActive ? ROW_ACTIVE : ROW_NORMAL);
+    if (row.state == ROW_HIDDEN)
+    {
+        lv_obj_clear_flag(row.label, LV_OBJ_FLAG_HIDDEN);
+        row.state = ROW_NORMAL;
+    }
+    if (state != row.state)
+    {
+        lv_obj_remove_style(row.label, style_for_state(row.state), 0);
+        lv_obj_add_style(row.label, style_for_state(state), 0);
+        row.state = state;
+    }
+}
+
+static void render_visible_rows()
+{
+    for (int slot = 0; slot < DEVICE_LIST_VISIBLE_ROWS; slot++)
+    {
+        render_device_row(slot);
+    }
+}
+
 void lvgl_create_device_screen()
 {
     // Create device screen with dark theme
@@ -36,11 +213,23 @@ void lvgl_create_device_screen()
     lv_obj_set_style_border_width(device_list_container, 1, 0);
     lv_obj_set_style_border_color(device_list_container, lv_color_hex(0x333333), 0);
     lv_obj_set_style_radius(device_list_container, 8, 0);
+    lv_obj_set_style_pad_all(device_list_container, 0, 0);
     lv_obj_clear_flag(device_list_container, LV_OBJ_FLAG_SCROLLABLE);
 
+    // Selection position (e.g. "3/14") for lists longer than the window
+    device_position_label = lv_label_create(device_screen);
+    lv_label_set_text(device_position_label, "");
+    lv_obj_set_style_text_color(device_position_label, lv_color_hex(0x888888), 0);
+    lv_obj_set_style_text_font(device_position_label, &lv_font_montserrat_10, 0);
+    lv_obj_align(device_position_label, LV_ALIGN_TOP_RIGHT, -12, 14);
+
+    // Pooled device rows with shared styles
+    init_row_styles();
+    create_device_rows();
+
     // Instructions label
     device_instruction_label = lv_label_create(device_screen);
-    lv_label_set_text(device_instruction_label, "🎵 Next/Prev: Navigate  🎵 Play: Select  🎵 Back: Triple Press");
+    lv_label_set_text(device_instruction_label, "🎵 Next/Prev: Navigate  🎵 Play: Select  🎵 Back: Hold Play");
     lv_obj_set_style_text_color(device_instruction_label, lv_color_hex(0x888888), 0);
     lv_obj_set_style_text_font(device_instruction_label, &lv_font_montserrat_10, 0);
     lv_obj_align(device_instruction_label, LV_ALIGN_BOTTOM_MID, 0, -5);
@@ -50,13 +239,26 @@ void lvgl_create_device_screen()
     Serial0.println("✅ Device screen created");
 }
 
-void lvgl_update_device_list(SpotifyDevice devices[], int deviceCount)
+void lvgl_update_device_list(const std::vector<SpotifyDevice> &devices)
 {
+    // Keep the selection on the same device if a refresh reorders the list
+    String selectedId = "";
+    if (selectedDeviceIndex >= 0 && selectedDeviceIndex < currentDeviceCount)
+    {
+        selectedId = currentDevices[selectedDeviceIndex].id;
+    }
+
     // Store device data
-    currentDeviceCount = min(deviceCount, 10);
-    for (int i = 0; i < currentDeviceCount; i++)
+    currentDevices = devices;
+    currentDeviceCount = currentDevices.size();
+
+    for (int i = 0; i < currentDeviceCount && selectedId.length() > 0; i++)
     {
-        currentDevices[i] = devices[i];
+        if (currentDevices[i].id == selectedId)
+        {
+            selectedDeviceIndex = i;
+            break;
+        }
     }
 
     // Only reset selectedDeviceIndex if this is the first load or current index is invalid
@@ -79,59 +281,10 @@ void lvgl_update_device_list(SpotifyDevice devices[], int deviceCount)
         Serial0.printf("🔒 Preserving selectedDeviceIndex at %d\n", selectedDeviceIndex);
     }
 
-    // Clear existing device labels
-    lv_obj_clean(device_list_container);
-
-    // Create device labels
-    for (int i = 0; i < currentDeviceCount; i++)
-    {
-        lv_obj_t *device_label = lv_label_create(device_list_container);
-
-        // Format device text
-        String deviceText = "";
-        if (i == selectedDeviceIndex)
-        {
-            deviceText += "► ";
-        }
-        else
-        {
-            deviceText += "  ";
-        }
-
-        deviceText += currentDevices[i].name;
-        if (currentDevices[i].isActive)
-        {
-            deviceText += " ✓";
-        }
-        deviceText += " (" + currentDevices[i].type + ")";
-        if (currentDevices[i].volumePercent > 0)
-        {
-            deviceText += " " + String(currentDevices[i].volumePercent) + "%";
-        }
-
-        lv_label_set_text(device_label, deviceText.c_str());
-
-        // Style based on selection and active state
-        if (i == selectedDeviceIndex)
-        {
-            lv_obj_set_style_text_color(device_label, lv_color_hex(0x1db954), 0);
-            lv_obj_set_style_bg_color(device_label, lv_color_hex(0x2a2a2a), 0);
-            lv_obj_set_style_bg_opa(device_label, LV_OPA_50, 0);
-        }
-        else if (currentDevices[i].isActive)
-        {
-            lv_obj_set_style_text_color(device_label, lv_color_hex(0x4fc3f7), 0);
-        }
-        else
-        {
-            lv_obj_set_style_text_color(device_label, lv_color_hex(0xcccccc), 0);
-        }
-
-        lv_obj_set_style_text_font(device_label, &lv_font_montserrat_12, 0);
-        lv_obj_set_pos(device_label, 10, 10 + (i * 25));
-        lv_obj_set_width(device_label, 280);
-        lv_label_set_long_mode(device_label, LV_LABEL_LONG_DOT);
-    }
+    // Patch visible rows in place; unchanged rows issue no LVGL calls
+    scroll_to_selection();
+    render_visible_rows();
+    update_position_label();
 
     Serial0.printf("Updated device list with %d devices, selectedIndex=%d\n", currentDeviceCount, selectedDeviceIndex);
 }
@@ -166,11 +319,23 @@ void lvgl_navigate_devices(int direction)
     Serial0.printf("📱 Navigated from device %d to %d: '%s'\n",
                    oldIndex, newIndex, currentDevices[newIndex].name.c_str());
 
-    // Play navigation sound
-    audioManager.playBeep(600 + (direction > 0 ? 200 : -200), 80);
+    // Without scrolling only the previously and newly selected rows change;
+    // when the window moves every slot is rebound to its new device
+    int64_t renderStart = esp_timer_get_time();
+    if (scroll_to_selection())
+    {
+        render_visible_rows();
+    }
+    else
+    {
+        render_device_row(oldIndex - windowTop);
+        render_device_row(newIndex - windowTop);
+    }
+    update_position_label();
+    Serial0.printf("🧭 Device rows updated in %lld us\n", esp_timer_get_time() - renderStart);
 
-    // Refresh the display
-    lvgl_update_device_list(currentDevices, currentDeviceCount);
+    // Play navigation sound
+    audioManager.playEarcon(direction > 0 ? EARCON_NAV_DOWN : EARCON_NAV_UP);
 }
 
 void lvgl_show_device_screen()
@@ -178,16 +343,25 @@ void lvgl_show_device_screen()
     Serial0.println("Showing device screen");
     lv_scr_load(device_screen);
 
-    // Refresh device list when showing screen
-    SpotifyDevice devices[10];
-    int deviceCount;
-    if (spotifyManager.getDevices(devices, 10, deviceCount))
-    {
-        lvgl_update_device_list(devices, deviceCount);
-    }
-    else
+    // Render the last known list instantly, then revalidate in the background
+    std::vector<SpotifyDevice> devices;
+    renderedCacheGeneration = spotifyManager.getCachedDevices(devices);
+    lvgl_update_device_list(devices);
+    spotifyManager.requestDeviceRefresh();
+}
+
+// Patch in a revalidated device list once the background refresh lands
+void lvgl_process_device_updates()
+{
+    if (spotifyManager.getDeviceCacheGeneration() == renderedCacheGeneration)
+        return;
+
+    std::vector<SpotifyDevice> devices;
+    renderedCacheGeneration = spotifyManager.getCachedDevices(devices);
+    if (lv_scr_act() == device_screen)
     {
-        Serial0.println("Failed to get devices");
+        Serial0.println("📱 Device list revalidated - patching rows");
+        lvgl_update_device_list(devices);
     }
 }
 
@@ -207,7 +381,7 @@ void lvgl_select_current_device()
     if (currentDeviceCount == 0 || selectedDeviceIndex >= currentDeviceCount)
     {
         Serial0.println("❌ No devices available or invalid selection");
-        audioManager.playBeep(400, 200);
+        audioManager.playEarcon(EARCON_REJECT);
         return;
     }
 
@@ -218,15 +392,13 @@ void lvgl_select_current_device()
     // Don't switch if already active
     if (currentDevices[selectedDeviceIndex].isActive)
     {
-        audioManager.playBeep(800, 200);
+        audioManager.playEarcon(EARCON_ALREADY_ACTIVE);
         Serial0.println("⚠️ Device already active - no transfer needed");
         return;
     }
 
     // Play selection sound
-    audioManager.playBeep(1000, 150);
-    delay(100);
-    audioManager.playBeep(1200, 150);
+    audioManager.playEarcon(EARCON_SELECT);
 
     Serial0.printf("🔄 Transferring playback to device: %s\n", currentDevices[selectedDeviceIndex].name.c_str());
 
@@ -244,11 +416,10 @@ void lvgl_select_current_device()
         }
 
         // Update display immediately
-        lvgl_update_device_list(currentDevices, currentDeviceCount);
+        render_visible_rows();
 
         // Play success sound
-        delay(300);
-        audioManager.playBeep(1500, 200);
+        audioManager.playEarcon(EARCON_CONFIRM);
 
         Serial0.println("✅ Device selection completed successfully");
 
@@ -261,10 +432,6 @@ void lvgl_select_current_device()
     {
         Serial0.println("❌ Failed to transfer playback - API call failed");
         // Play error sound - distinctive double beep
-        audioManager.playBeep(400, 200);
-        delay(100);
-        audioManager.playBeep(400, 200);
-        delay(100);
-        audioManager.playBeep(400, 200);
+        audioManager.playEarcon(EARCON_ERROR);
     }
 }
@@ -5,6 +5,9 @@
 static lv_disp_draw_buf_t draw_buf;
 static lv_color_t buf[320 * 10]; // 10 lines buffer
 
+// Total pixels pushed to the panel since boot (redraw cost metric)
+static volatile uint32_t flushed_pixels = 0;
+
 // Display flushing callback
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
@@ -16,9 +19,15 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
     tft.pushColors((uint16_t*)&color_p->full, w * h, true);
     tft.endWrite();
 
+    flushed_pixels += w * h;
     lv_disp_flush_ready(disp);
 }
 
+uint32_t lvgl_get_flushed_pixels()
+{
+    return flushed_pixels;
+}
+
 // Initialize LVGL display
 void lvgl_init_display()
 {
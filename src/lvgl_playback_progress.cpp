@@ -0,0 +1,193 @@
+#include "lvgl_playback_progress.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Progress widgets
+static lv_obj_t *progress_bar = nullptr;
+static lv_obj_t *elapsed_label = nullptr;
+static lv_obj_t *remaining_label = nullptr;
+
+// Client-side playback clock. Position is extrapolated from the last Spotify
+// sample using esp_timer time; on resync, small errors are slewed away over
+// time instead of making the bar jump.
+struct PlaybackClock
+{
+    bool valid;
+    bool playing;
+    int32_t durationMs;
+    int32_t anchorProgressMs; // progress_ms of the last sample
+    int64_t anchorUs;         // esp_timer time progress_ms was valid (request midpoint)
+    int32_t correctionMs;     // Residual display offset being smoothed out
+    int64_t correctionStartUs;
+    int64_t correctionSpanUs;
+    String trackId;
+};
+
+static PlaybackClock playbackClock = {false, false, 0, 0, 0, 0, 0, 0, ""};
+
+// Last rendered values (-1 forces a redraw)
+static int32_t renderedPx = -1;
+static int32_t renderedElapsedSec = -1;
+static int32_t renderedRemainingSec = -1;
+
+// Resync stats, logged once per interval
+static int64_t statsWindowStartUs = 0;
+static uint32_t statsResyncs = 0;
+static uint32_t statsSmoothed = 0;
+static int32_t statsMaxDriftMs = 0;
+static int64_t statsMaxSampleAgeUs = 0;
+
+static int32_t clock_position_ms(int64_t nowUs)
+{
+    int64_t position = playbackClock.anchorProgressMs;
+    if (playbackClock.playing) {
+        position += (nowUs - playbackClock.anchorUs) / 1000;
+    }
+
+    if (playbackClock.correctionMs != 0) {
+        int64_t elapsed = nowUs - playbackClock.correctionStartUs;
+        if (elapsed >= playbackClock.correctionSpanUs) {
+            playbackClock.correctionMs = 0;
+        } else {
+            position += (int64_t)playbackClock.correctionMs * (playbackClock.correctionSpanUs - elapsed) /
+                        playbackClock.correctionSpanUs;
+        }
+    }
+
+    if (position < 0) position = 0;
+    if (position > playbackClock.durationMs) position = playbackClock.durationMs;
+    return (int32_t)position;
+}
+
+static void format_time(char *out, size_t outSize, const char *prefix, int32_t seconds)
+{
+    snprintf(out, outSize, "%s%ld:%02ld", prefix, (long)(seconds / 60), (long)(seconds % 60));
+}
+
+void lvgl_create_playback_progress(lv_obj_t *parent)
+{
+    // Thin progress bar below the album art / track info row
+    progress_bar = lv_bar_create(parent);
+    lv_obj_set_size(progress_bar, PROGRESS_BAR_WIDTH, PROGRESS_BAR_HEIGHT);
+    lv_obj_align(progress_bar, LV_ALIGN_BOTTOM_MID, 0, -18);
+    lv_bar_set_range(progress_bar, 0, PROGRESS_BAR_WIDTH);
+    lv_bar_set_value(progress_bar, 0, LV_ANIM_OFF);
+    lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x333333), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x1db954), LV_PART_INDICATOR);
+    lv_obj_set_style_radius(progress_bar, 2, LV_PART_MAIN);
+    lv_obj_set_style_radius(progress_bar, 2, LV_PART_INDICATOR);
+
+    // Elapsed time (left of bar)
+    elapsed_label = lv_label_create(parent);
+    lv_label_set_text(elapsed_label, "--:--");
+    lv_obj_set_style_text_color(elapsed_label, lv_color_hex(0x888888), 0);
+    lv_obj_set_style_text_font(elapsed_label, &lv_font_montserrat_10, 0);
+    lv_obj_align(elapsed_label, LV_ALIGN_BOTTOM_LEFT, 10, -14);
+
+    // Remaining time (right of bar)
+    remaining_label = lv_label_create(parent);
+    lv_label_set_text(remaining_label, "--:--");
+    lv_obj_set_style_text_color(remaining_label, lv_color_hex(0x888888), 0);
+    lv_obj_set_style_text_font(remaining_label, &lv_font_montserrat_10, 0);
+    lv_obj_align(remaining_label, LV_ALIGN_BOTTOM_RIGHT, -10, -14);
+}
+
+// Resynchronize the local clock from a fresh playback state sample
+void lvgl_sync_playback_progress(const SpotifyTrack& track, bool trackValid)
+{
+    if (!progress_bar)
+        return;
+
+    if (!trackValid || track.duration_ms <= 0) {
+        if (playbackClock.valid) {
+            playbackClock.valid = false;
+            lv_bar_set_value(progress_bar, 0, LV_ANIM_OFF);
+            lv_label_set_text(elapsed_label, "--:--");
+            lv_label_set_text(remaining_label, "--:--");
+            renderedPx = renderedElapsedSec = renderedRemainingSec = -1;
+        }
+        return;
+    }
+
+    // progress_ms was valid at sampledAtUs, not now: the response spent half the
+    // round trip (and the parse) in flight
+    int64_t nowUs = esp_timer_get_time();
+    int64_t sampleUs = track.sampledAtUs > 0 && track.sampledAtUs <= nowUs ? track.sampledAtUs : nowUs;
+    bool sameTrack = playbackClock.valid && playbackClock.trackId == track.trackId;
+    int32_t errorMs = 0;
+
+    if (sameTrack && playbackClock.playing == track.isPlaying) {
+        // Drift between our extrapolation and the server, positive = we were ahead
+        errorMs = clock_position_ms(sampleUs) - track.progress_ms;
+    }
+
+    playbackClock.valid = true;
+    playbackClock.playing = track.isPlaying;
+    playbackClock.durationMs = track.duration_ms;
+    playbackClock.anchorProgressMs = track.progress_ms;
+    playbackClock.anchorUs = sampleUs;
+    playbackClock.trackId = track.trackId;
+
+    if (errorMs != 0 && abs(errorMs) <= PROGRESS_SNAP_THRESHOLD_MS) {
+        // Keep the display continuous and converge on the new sample. The span is at
+        // least twice the error so the displayed position never runs backwards.
+        playbackClock.correctionMs = errorMs;
+        playbackClock.correctionStartUs = nowUs;
+        playbackClock.correctionSpanUs = (int64_t)max(PROGRESS_MIN_SLEW_MS, 2 * abs(errorMs)) * 1000;
+    } else {
+        // Seek, track change, play/pause toggle or first sample: snap
+        playbackClock.correctionMs = 0;
+    }
+
+    statsResyncs++;
+    if (playbackClock.correctionMs != 0) {
+        statsSmoothed++;
+        statsMaxDriftMs = max(statsMaxDriftMs, (int32_t)abs(errorMs));
+    }
+    statsMaxSampleAgeUs = max(statsMaxSampleAgeUs, nowUs - sampleUs);
+    if (statsWindowStartUs == 0) {
+        statsWindowStartUs = nowUs;
+    } else if (nowUs - statsWindowStartUs >= PROGRESS_STATS_INTERVAL_MS * 1000LL) {
+        Serial0.printf("⏱️ Playback clock: %lu resyncs, %lu smoothed (max drift %ld ms), max sample age %lu ms\n",
+                       (unsigned long)statsResyncs, (unsigned long)statsSmoothed, (long)statsMaxDriftMs,
+                       (unsigned long)(statsMaxSampleAgeUs / 1000));
+        statsWindowStartUs = nowUs;
+        statsResyncs = statsSmoothed = 0;
+        statsMaxDriftMs = 0;
+        statsMaxSampleAgeUs = 0;
+    }
+
+    lvgl_update_playback_progress();
+}
+
+// Advance the progress display from the local clock (call from main loop)
+void lvgl_update_playback_progress()
+{
+    if (!progress_bar || !playbackClock.valid)
+        return;
+
+    int32_t positionMs = clock_position_ms(esp_timer_get_time());
+
+    // Only touch the bar when the indicator moves by at least one pixel
+    int32_t px = (int32_t)((int64_t)positionMs * PROGRESS_BAR_WIDTH / playbackClock.durationMs);
+    if (px != renderedPx) {
+        renderedPx = px;
+        lv_bar_set_value(progress_bar, px, LV_ANIM_OFF);
+    }
+
+    // Labels change once per displayed second
+    char text[16];
+    int32_t elapsedSec = positionMs / 1000;
+    if (elapsedSec != renderedElapsedSec) {
+        renderedElapsedSec = elapsedSec;
+        format_time(text, sizeof(text), "", elapsedSec);
+        lv_label_set_text(elapsed_label, text);
+    }
+
+    int32_t remainingSec = (playbackClock.durationMs - positionMs + 999) / 1000;
+    if (remainingSec != renderedRemainingSec) {
+        renderedRemainingSec = remainingSec;
+        format_time(text, sizeof(text), "-", remainingSec);
+        lv_label_set_text(remaining_label, text);
+    }
+}
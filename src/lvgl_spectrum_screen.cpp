@@ -0,0 +1,297 @@
+#include "lvgl_spectrum_screen.h"
+#include "lvgl_display.h"
+#include "audio_manager.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+
+lv_obj_t *spectrum_screen;
+static lv_obj_t *spectrum_plot = nullptr;
+static lv_timer_t *spectrum_timer = nullptr;
+
+#define SPECTRUM_BAR_PITCH (SPECTRUM_PLOT_WIDTH / NUM_BANDS)
+#define SPECTRUM_BAR_WIDTH (SPECTRUM_BAR_PITCH - SPECTRUM_BAR_GAP)
+#define SPECTRUM_PEAK_MAX (SPECTRUM_PLOT_HEIGHT - SPECTRUM_PEAK_HEIGHT)
+
+// Colors are fixed per row band (not per bar level), so a bar that grows or
+// shrinks only needs the rows between its old and new top redrawn
+struct SpectrumZone
+{
+    uint8_t fromPercent;
+    uint32_t color;
+};
+
+static const SpectrumZone zones[] = {
+    {0, 0x1db954},  // Spotify green
+    {20, 0xffd700}, // Yellow
+    {40, 0xffa500}, // Orange
+    {70, 0xff4040}, // Red
+};
+#define SPECTRUM_ZONE_COUNT (sizeof(zones) / sizeof(zones[0]))
+
+static const char *bandLabels[NUM_BANDS] = {"63", "125", "250", "500", "1k", "2k", "4k", "8k"};
+
+// Rendered state, in pixels above the plot bottom
+static int16_t barPx[NUM_BANDS];
+static int16_t peakPx[NUM_BANDS];
+static int32_t peakQ8[NUM_BANDS];
+static int32_t peakVelocityQ8[NUM_BANDS];
+static uint8_t peakHold[NUM_BANDS];
+
+static uint32_t renderedSequence = 0;
+static int64_t seenOnsetUs = 0;
+static int64_t pendingOnsetUs = 0; // Onset waiting for its first visible bar movement
+
+static SpectrumRenderStats stats = {0, 0, 0, 0, 0, 0, UINT32_MAX, 0, 0};
+static int64_t statsWindowStartUs = 0;
+static uint32_t statsWindowFrames = 0;
+static uint32_t statsWindowPx = 0;
+static uint32_t statsWindowFlushedPx = 0;
+
+// Horizontal extent of a bar in absolute coordinates
+static void bar_columns(const lv_area_t &plot, int band, lv_coord_t *x1, lv_coord_t *x2)
+{
+    *x1 = plot.x1 + band * SPECTRUM_BAR_PITCH + SPECTRUM_BAR_GAP / 2;
+    *x2 = *x1 + SPECTRUM_BAR_WIDTH - 1;
+}
+
+static void spectrum_draw_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_area_t *clip = draw_ctx->clip_area;
+
+    lv_area_t plot;
+    lv_obj_get_coords(obj, &plot);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+
+    for (int band = 0; band < NUM_BANDS; band++)
+    {
+        lv_area_t area;
+        bar_columns(plot, band, &area.x1, &area.x2);
+        if (area.x2 < clip->x1 || area.x1 > clip->x2)
+            continue;
+
+        // Bar, one rectangle per color zone it reaches
+        lv_coord_t barTop = plot.y2 - barPx[band] + 1;
+        for (size_t z = 0; z < SPECTRUM_ZONE_COUNT && barPx[band] > 0; z++)
+        {
+            lv_coord_t zoneBottom = plot.y2 - (SPECTRUM_PLOT_HEIGHT * zones[z].fromPercent) / 100;
+            lv_coord_t zoneTop = (z + 1 < SPECTRUM_ZONE_COUNT)
+                                     ? plot.y2 - (SPECTRUM_PLOT_HEIGHT * zones[z + 1].fromPercent) / 100 + 1
+                                     : plot.y1;
+            area.y1 = max(zoneTop, barTop);
+            area.y2 = zoneBottom;
+            if (area.y1 > area.y2)
+                break;
+
+            dsc.bg_color = lv_color_hex(zones[z].color);
+            lv_draw_rect(draw_ctx, &dsc, &area);
+        }
+
+        // Peak marker sits directly above the bar when they meet
+        if (peakPx[band] > 0)
+        {
+            area.y2 = plot.y2 - peakPx[band];
+            area.y1 = area.y2 - SPECTRUM_PEAK_HEIGHT + 1;
+            dsc.bg_color = lv_color_hex(0xffffff);
+            lv_draw_rect(draw_ctx, &dsc, &area);
+        }
+    }
+}
+
+// Invalidate rows [bottom - to, bottom - from) of one bar's columns
+static uint32_t invalidate_rows(const lv_area_t &plot, int band, int16_t from, int16_t to)
+{
+    if (from == to)
+        return 0;
+
+    lv_area_t area;
+    bar_columns(plot, band, &area.x1, &area.x2);
+    area.y1 = plot.y2 - max(from, to) + 1;
+    area.y2 = plot.y2 - min(from, to);
+    lv_obj_invalidate_area(spectrum_plot, &area);
+    return lv_area_get_size(&area);
+}
+
+static int16_t update_peak(int band, int16_t height)
+{
+    if (((int32_t)height << 8) >= peakQ8[band])
+    {
+        peakQ8[band] = (int32_t)height << 8;
+        peakVelocityQ8[band] = 0;
+        peakHold[band] = SPECTRUM_PEAK_HOLD_FRAMES;
+    }
+    else if (peakHold[band] > 0)
+    {
+        peakHold[band]--;
+    }
+    else
+    {
+        peakVelocityQ8[band] += SPECTRUM_PEAK_GRAVITY_Q8;
+        peakQ8[band] = max(peakQ8[band] - peakVelocityQ8[band], (int32_t)height << 8);
+    }
+
+    return (int16_t)min(peakQ8[band] >> 8, (int32_t)SPECTRUM_PEAK_MAX);
+}
+
+static void spectrum_timer_cb(lv_timer_t *timer)
+{
+    int64_t start = esp_timer_get_time();
+
+    // Newest smoothed bands; a busy writer or no new frame means nothing to do
+    SpectrumFrame frame;
+    if (!audioManager.getSpectrumFrame(frame) || frame.sequence == renderedSequence)
+    {
+        stats.staleFrames++;
+        return;
+    }
+    renderedSequence = frame.sequence;
+
+    if (frame.onsetUs != seenOnsetUs)
+    {
+        seenOnsetUs = frame.onsetUs;
+        pendingOnsetUs = frame.onsetUs;
+    }
+
+    lv_area_t plot;
+    lv_obj_get_coords(spectrum_plot, &plot);
+
+    uint32_t framePx = 0;
+    bool barRose = false;
+    for (int band = 0; band < NUM_BANDS; band++)
+    {
+        int16_t height = (int16_t)constrain((int)(frame.bands[band] * SPECTRUM_PLOT_HEIGHT), 0, SPECTRUM_PLOT_HEIGHT);
+        int16_t peak = update_peak(band, height);
+        barRose |= height - barPx[band] >= SPECTRUM_LATENCY_RISE_PX;
+
+        framePx += invalidate_rows(plot, band, barPx[band], height);
+        if (peak != peakPx[band])
+        {
+            // Old and new marker rows (the bar rows in between were handled above)
+            framePx += invalidate_rows(plot, band, peakPx[band], peakPx[band] + SPECTRUM_PEAK_HEIGHT);
+            framePx += invalidate_rows(plot, band, peak, peak + SPECTRUM_PEAK_HEIGHT);
+        }
+
+        barPx[band] = height;
+        peakPx[band] = peak;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (barRose && pendingOnsetUs != 0)
+    {
+        uint32_t latency = (uint32_t)(now - pendingOnsetUs);
+        pendingOnsetUs = 0;
+        stats.latencySamples++;
+        stats.latencySumUs += latency;
+        stats.latencyMinUs = min(stats.latencyMinUs, latency);
+        stats.latencyMaxUs = max(stats.latencyMaxUs, latency);
+    }
+
+    stats.frames++;
+    stats.invalidatedPx += framePx;
+    stats.maxFrameUs = max(stats.maxFrameUs, (uint32_t)(now - start));
+    if (framePx == 0)
+    {
+        stats.idleFrames++;
+    }
+
+    statsWindowFrames++;
+    statsWindowPx += framePx;
+    if (now - statsWindowStartUs >= SPECTRUM_STATS_INTERVAL_MS * 1000LL)
+    {
+        float seconds = (now - statsWindowStartUs) / 1000000.0f;
+        uint32_t flushed = lvgl_get_flushed_pixels();
+        Serial0.printf("📊 Spectrum: %.1f FPS, %lu px invalidated/frame (plot %d px), %lu px flushed/s, max frame %lu us\n",
+                       statsWindowFrames / seconds, (unsigned long)(statsWindowPx / max(statsWindowFrames, (uint32_t)1)),
+                       SPECTRUM_PLOT_WIDTH * SPECTRUM_PLOT_HEIGHT,
+                       (unsigned long)((flushed - statsWindowFlushedPx) / seconds), (unsigned long)stats.maxFrameUs);
+        if (stats.latencySamples > 0)
+        {
+            // Measured to invalidation; the flush follows within one refresh period
+            Serial0.printf("📊 Sound-to-bar latency: %lu/%lu/%lu us min/avg/max over %lu onsets (data age now %lu us)\n",
+                           (unsigned long)stats.latencyMinUs,
+                           (unsigned long)(stats.latencySumUs / stats.latencySamples),
+                           (unsigned long)stats.latencyMaxUs, (unsigned long)stats.latencySamples,
+                           (unsigned long)(now - frame.timestampUs));
+        }
+        statsWindowStartUs = now;
+        statsWindowFrames = 0;
+        statsWindowPx = 0;
+        statsWindowFlushedPx = flushed;
+    }
+}
+
+void lvgl_create_spectrum_screen()
+{
+    // Create spectrum screen with dark theme
+    spectrum_screen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(spectrum_screen, lv_color_hex(0x0f0f0f), 0);
+
+    // Title label
+    lv_obj_t *title_label = lv_label_create(spectrum_screen);
+    lv_label_set_text(title_label, LV_SYMBOL_AUDIO " Spectrum");
+    lv_obj_set_style_text_color(title_label, lv_color_hex(0x1db954), 0);
+    lv_obj_set_style_text_font(title_label, &lv_font_montserrat_16, 0);
+    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 10);
+
+    // Plot: transparent object drawn by the callback, no styles of its own to render
+    spectrum_plot = lv_obj_create(spectrum_screen);
+    lv_obj_remove_style_all(spectrum_plot);
+    lv_obj_set_size(spectrum_plot, SPECTRUM_PLOT_WIDTH, SPECTRUM_PLOT_HEIGHT);
+    lv_obj_align(spectrum_plot, LV_ALIGN_TOP_MID, 0, 40);
+    lv_obj_clear_flag(spectrum_plot, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(spectrum_plot, spectrum_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    // Band labels (static)
+    for (int band = 0; band < NUM_BANDS; band++)
+    {
+        lv_obj_t *label = lv_label_create(spectrum_screen);
+        lv_label_set_text(label, bandLabels[band]);
+        lv_obj_set_style_text_color(label, lv_color_hex(0x888888), 0);
+        lv_obj_set_style_text_font(label, &lv_font_montserrat_12, 0);
+        lv_obj_align_to(label, spectrum_plot, LV_ALIGN_OUT_BOTTOM_LEFT,
+                        band * SPECTRUM_BAR_PITCH + SPECTRUM_BAR_GAP / 2, 6);
+    }
+
+    spectrum_timer = lv_timer_create(spectrum_timer_cb, SPECTRUM_FRAME_MS, NULL);
+    lv_timer_pause(spectrum_timer);
+
+    Serial0.println("✅ Spectrum screen created");
+}
+
+void lvgl_show_spectrum_screen()
+{
+    Serial0.println("Showing spectrum screen");
+
+    // Start from an empty plot
+    memset(barPx, 0, sizeof(barPx));
+    memset(peakPx, 0, sizeof(peakPx));
+    memset(peakQ8, 0, sizeof(peakQ8));
+    memset(peakVelocityQ8, 0, sizeof(peakVelocityQ8));
+    memset(peakHold, 0, sizeof(peakHold));
+    pendingOnsetUs = 0;
+    lv_obj_invalidate(spectrum_plot);
+
+    lv_scr_load(spectrum_screen);
+    audioManager.startRecording();
+
+    statsWindowStartUs = esp_timer_get_time();
+    statsWindowFrames = 0;
+    statsWindowPx = 0;
+    statsWindowFlushedPx = lvgl_get_flushed_pixels();
+    lv_timer_resume(spectrum_timer);
+}
+
+void lvgl_hide_spectrum_screen()
+{
+    Serial0.println("Hiding spectrum screen");
+    lv_timer_pause(spectrum_timer);
+    audioManager.stopRecording();
+}
+
+const SpectrumRenderStats &lvgl_get_spectrum_stats()
+{
+    return stats;
+}
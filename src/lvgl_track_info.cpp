@@ -1,60 +1,167 @@
 #include "lvgl_track_info.h"
 #include "lvgl_ui_components.h"
 #include "lvgl_album_art.h"
+#include "lvgl_display.h"
+#include "lvgl_playback_progress.h"
+#include "lvgl_volume_overlay.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 
-// Update track information
-void lvgl_update_track_info(const SpotifyTrack& track, bool trackValid)
+// Status label colors
+#define STATUS_COLOR_PLAYING 0x1db954
+#define STATUS_COLOR_PAUSED 0xffa500
+
+// Last state rendered into the track info widgets. New track data is compared
+// against it field by field so that an unchanged poll issues no LVGL calls
+// (and therefore no invalidation, relayout or scroll animation restart).
+struct TrackViewModel
 {
-    static String lastImageUrl = "";
-    
-    if (!trackValid) {
-        lv_label_set_text(track_label, "No track playing");
-        lv_label_set_text(artist_label, "Start playing on Spotify");
-        lv_label_set_text(album_label, "");
-        lv_label_set_text(status_label, "Stopped");
-        
-        // Show placeholder when no track
-        lvgl_show_album_placeholder();
-        lastImageUrl = "";
+    bool initialized;
+    bool valid;
+    String name;
+    String artist;
+    String album;
+    char status[128];
+    uint32_t statusColor;
+};
+
+static TrackViewModel rendered = {false, false, "", "", "", "", 0};
+static TrackInfoRenderStats stats = {0, 0, 0, 0, 0};
+static uint32_t pendingInvalidatedPx = 0;
+
+// Stats logging window
+static int64_t statsWindowStartUs = 0;
+static uint32_t statsWindowUpdates = 0;
+static uint32_t statsWindowIdle = 0;
+static uint32_t statsWindowPx = 0;
+
+// Account for the area LVGL invalidates when a widget is mutated
+static void count_mutation(lv_obj_t *obj)
+{
+    lv_area_t area;
+    lv_obj_get_coords(obj, &area);
+    pendingInvalidatedPx += lv_area_get_size(&area);
+    stats.widgetMutations++;
+}
+
+static void set_label_if_changed(lv_obj_t *label, String &renderedText, const String &text)
+{
+    if (rendered.initialized && renderedText == text)
         return;
+
+    renderedText = text;
+    lv_label_set_text(label, text.c_str());
+    count_mutation(label);
+}
+
+static void set_status_if_changed(const char *text, uint32_t color, bool updateColor)
+{
+    if (!rendered.initialized || strcmp(rendered.status, text) != 0)
+    {
+        strlcpy(rendered.status, text, sizeof(rendered.status));
+        lv_label_set_text(status_label, text);
+        count_mutation(status_label);
     }
 
-    // Update track info
-    lv_label_set_text(track_label, track.name.c_str());
-    lv_label_set_text(artist_label, track.artist.c_str());
-    lv_label_set_text(album_label, track.album.c_str());
-    
-    // Update status with enhanced playback information
-    String statusText = "";
-    if (track.isPlaying) {
-        statusText = "Playing";
-        lv_obj_set_style_text_color(status_label, lv_color_hex(0x1db954), 0);
-    } else {
-        statusText = "Paused";
-        lv_obj_set_style_text_color(status_label, lv_color_hex(0xffa500), 0);
+    if (updateColor && (!rendered.initialized || rendered.statusColor != color))
+    {
+        rendered.statusColor = color;
+        lv_obj_set_style_text_color(status_label, lv_color_hex(color), 0);
+        count_mutation(status_label);
     }
-    
+}
+
+// Build the status line (playback state, shuffle/repeat, device) without heap churn
+static void format_status(const SpotifyTrack& track, char *out, size_t outSize)
+{
+    int len = snprintf(out, outSize, "%s", track.isPlaying ? "Playing" : "Paused");
+
     // Add shuffle/repeat indicators
-    if (track.shuffleState) {
-        statusText += " 🔀";
+    if (track.shuffleState && len < (int)outSize) {
+        len += snprintf(out + len, outSize - len, " 🔀");
     }
-    if (track.repeatState == "track") {
-        statusText += " 🔂";
-    } else if (track.repeatState == "context") {
-        statusText += " 🔁";
+    if (track.repeatState == "track" && len < (int)outSize) {
+        len += snprintf(out + len, outSize - len, " 🔂");
+    } else if (track.repeatState == "context" && len < (int)outSize) {
+        len += snprintf(out + len, outSize - len, " 🔁");
     }
-    
+
     // Add device info if available
-    if (track.deviceName.length() > 0) {
-        statusText += " • " + track.deviceName;
-        if (track.deviceVolume > 0) {
-            statusText += " (" + String(track.deviceVolume) + "%)";
+    if (track.deviceName.length() > 0 && len < (int)outSize) {
+        len += snprintf(out + len, outSize - len, " • %s", track.deviceName.c_str());
+        if (track.deviceVolume > 0 && len < (int)outSize) {
+            snprintf(out + len, outSize - len, " (%d%%)", track.deviceVolume);
         }
     }
-    
-    lv_label_set_text(status_label, statusText.c_str());
-    
+}
+
+static void finish_update()
+{
+    rendered.initialized = true;
+
+    stats.updates++;
+    stats.lastInvalidatedPx = pendingInvalidatedPx;
+    stats.totalInvalidatedPx += pendingInvalidatedPx;
+    if (pendingInvalidatedPx == 0) {
+        stats.idleUpdates++;
+    }
+
+    statsWindowUpdates++;
+    statsWindowPx += pendingInvalidatedPx;
+    if (pendingInvalidatedPx == 0) {
+        statsWindowIdle++;
+    }
+    pendingInvalidatedPx = 0;
+
+    int64_t now = esp_timer_get_time();
+    if (statsWindowStartUs == 0) {
+        statsWindowStartUs = now;
+    } else if (now - statsWindowStartUs >= TRACK_INFO_STATS_INTERVAL_MS * 1000LL) {
+        Serial0.printf("🖼️ Track info: %lu px invalidated over %lu updates (%lu idle), %lu px flushed total\n",
+                       (unsigned long)statsWindowPx, (unsigned long)statsWindowUpdates,
+                       (unsigned long)statsWindowIdle, (unsigned long)lvgl_get_flushed_pixels());
+        statsWindowStartUs = now;
+        statsWindowUpdates = statsWindowIdle = statsWindowPx = 0;
+    }
+}
+
+// Update track information
+void lvgl_update_track_info(const SpotifyTrack& track, bool trackValid)
+{
+    static String lastImageUrl = "";
+
+    // Resync the local playback clock from every fresh sample
+    lvgl_sync_playback_progress(track, trackValid);
+    lvgl_sync_volume(track, trackValid);
+
+    if (!trackValid) {
+        set_label_if_changed(track_label, rendered.name, "No track playing");
+        set_label_if_changed(artist_label, rendered.artist, "Start playing on Spotify");
+        set_label_if_changed(album_label, rendered.album, "");
+        set_status_if_changed("Stopped", 0, false);
+
+        // Show placeholder when no track (only on the transition, it recreates the widget)
+        if (!rendered.initialized || rendered.valid) {
+            lvgl_show_album_placeholder();
+            count_mutation(album_img);
+        }
+        rendered.valid = false;
+        lastImageUrl = "";
+        finish_update();
+        return;
+    }
+
+    // Update track info
+    set_label_if_changed(track_label, rendered.name, track.name);
+    set_label_if_changed(artist_label, rendered.artist, track.artist);
+    set_label_if_changed(album_label, rendered.album, track.album);
+
+    // Update status with enhanced playback information
+    char statusText[sizeof(rendered.status)];
+    format_status(track, statusText, sizeof(statusText));
+    set_status_if_changed(statusText, track.isPlaying ? STATUS_COLOR_PLAYING : STATUS_COLOR_PAUSED, true);
+    rendered.valid = true;
+
     // Add progress information to Serial output for debugging
     if (track.duration_ms > 0 && track.progress_ms >= 0) {
         int progressPercent = (track.progress_ms * 100) / track.duration_ms;
@@ -62,13 +169,13 @@ void lvgl_update_track_info(const SpotifyTrack& track, bool trackValid)
         int progressSeconds = (track.progress_ms % 60000) / 1000;
         int totalMinutes = track.duration_ms / 60000;
         int totalSeconds = (track.duration_ms % 60000) / 1000;
-        
-        Serial0.printf("⏱️ Progress: %d:%02d / %d:%02d (%d%%)\n", 
-                      progressMinutes, progressSeconds, 
-                      totalMinutes, totalSeconds, 
+
+        Serial0.printf("⏱️ Progress: %d:%02d / %d:%02d (%d%%)\n",
+                      progressMinutes, progressSeconds,
+                      totalMinutes, totalSeconds,
                       progressPercent);
     }
-    
+
     // Handle album artwork changes with lazy loading
     if (track.imageUrl != lastImageUrl) {
         if (track.imageUrl.length() > 0) {
@@ -82,5 +189,13 @@ void lvgl_update_track_info(const SpotifyTrack& track, bool trackValid)
             lvgl_cleanup_album_art();
             lvgl_show_album_placeholder();
         }
+        count_mutation(album_img);
     }
-} 
\ No newline at end of file
+
+    finish_update();
+}
+
+const TrackInfoRenderStats& lvgl_get_track_info_stats()
+{
+    return stats;
+}
@@ -16,5 +16,11 @@ void lvgl_ui_init()
     // Create device selection screen
     lvgl_create_device_screen();
 
+    // Create microphone spectrum screen
+    lvgl_create_spectrum_screen();
+
+    // Volume overlay (top layer, shown while adjusting)
+    lvgl_create_volume_overlay();
+
     Serial0.println("✅ LVGL UI system initialized successfully");
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "lvgl_ui_components.h"
 #include "lvgl_album_art.h"
 #include "lvgl_device_screen.h"
+#include "lvgl_spectrum_screen.h"
+#include "lvgl_playback_progress.h"
 #include <Arduino.h>
 
 // Current screen state
@@ -105,18 +107,23 @@ void lvgl_create_ui()
     lv_obj_set_style_text_font(status_label, &lv_font_montserrat_12, 0);
     lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, -10);
 
+    // Playback progress bar with elapsed/remaining time
+    lvgl_create_playback_progress(main_screen);
+
     Serial0.println("✅ LVGL UI created successfully");
 }
 
-// Update WiFi status
-void lvgl_update_wifi_status(bool connected)
+// Update WiFi status (detail is shown next to the icon while not connected)
+void lvgl_update_wifi_status(bool connected, const char *detail)
 {
     if (connected)
     {
+        lv_label_set_text(wifi_status_label, LV_SYMBOL_WIFI);
         lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0x1db954), 0); // Green when connected
     }
     else
     {
+        lv_label_set_text_fmt(wifi_status_label, LV_SYMBOL_WIFI " %s", detail ? detail : "");
         lv_obj_set_style_text_color(wifi_status_label, lv_color_hex(0xffa500), 0); // Orange when connecting
     }
 }
@@ -126,6 +133,12 @@ void lvgl_switch_screen(UIScreen screen)
     if (screen == currentScreen)
         return;
 
+    // The spectrum screen owns the microphone and a frame timer while shown
+    if (currentScreen == SCREEN_SPECTRUM)
+    {
+        lvgl_hide_spectrum_screen();
+    }
+
     currentScreen = screen;
 
     switch (screen)
@@ -138,5 +151,9 @@ void lvgl_switch_screen(UIScreen screen)
         lvgl_show_device_screen();
         Serial0.println("Switched to device screen");
         break;
+    case SCREEN_SPECTRUM:
+        lvgl_show_spectrum_screen();
+        Serial0.println("Switched to spectrum screen");
+        break;
     }
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "lvgl_volume_overlay.h"
+#include <Arduino.h>
+
+// Overlay widgets
+static lv_obj_t *volume_panel = nullptr;
+static lv_obj_t *volume_bar = nullptr;
+static lv_obj_t *volume_label = nullptr;
+static lv_timer_t *volume_timer = nullptr;
+
+static int targetVolume = -1;     // Latest value (local or polled), -1 until known
+static int32_t displayedQ8 = 0;   // Eased value on screen, 1/256 %
+static int renderedVolume = -1;
+static unsigned long lastLocalChangeMs = 0;
+static bool localChangeMade = false;
+
+static void render_volume(int volume)
+{
+    if (volume == renderedVolume)
+        return;
+
+    renderedVolume = volume;
+    lv_bar_set_value(volume_bar, volume, LV_ANIM_OFF);
+    lv_label_set_text_fmt(volume_label, LV_SYMBOL_VOLUME_MAX " %d%%", volume);
+}
+
+// Every frame while visible: ease the bar toward the target, hide when idle
+static void volume_timer_cb(lv_timer_t *timer)
+{
+    int32_t targetQ8 = (int32_t)targetVolume << 8;
+    int32_t delta = targetQ8 - displayedQ8;
+    displayedQ8 = (abs(delta) < 64) ? targetQ8 : displayedQ8 + delta / 3;
+    render_volume((displayedQ8 + 128) >> 8);
+
+    if (displayedQ8 == targetQ8 && millis() - lastLocalChangeMs > VOLUME_OVERLAY_TIMEOUT_MS)
+    {
+        lv_obj_add_flag(volume_panel, LV_OBJ_FLAG_HIDDEN);
+        lv_timer_pause(volume_timer);
+    }
+}
+
+void lvgl_create_volume_overlay()
+{
+    // Panel on the top layer so it floats over whichever screen is loaded
+    volume_panel = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(volume_panel, VOLUME_OVERLAY_WIDTH, VOLUME_OVERLAY_HEIGHT);
+    lv_obj_align(volume_panel, LV_ALIGN_BOTTOM_MID, 0, -30);
+    lv_obj_set_style_bg_color(volume_panel, lv_color_hex(0x1a1a1a), 0);
+    lv_obj_set_style_border_width(volume_panel, 1, 0);
+    lv_obj_set_style_border_color(volume_panel, lv_color_hex(0x333333), 0);
+    lv_obj_set_style_radius(volume_panel, 8, 0);
+    lv_obj_set_style_pad_all(volume_panel, 0, 0);
+    lv_obj_clear_flag(volume_panel, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(volume_panel, LV_OBJ_FLAG_HIDDEN);
+
+    // Value label (left)
+    volume_label = lv_label_create(volume_panel);
+    lv_label_set_text(volume_label, LV_SYMBOL_VOLUME_MAX " --%");
+    lv_obj_set_style_text_color(volume_label, lv_color_hex(0xffffff), 0);
+    lv_obj_set_style_text_font(volume_label, &lv_font_montserrat_14, 0);
+    lv_obj_align(volume_label, LV_ALIGN_LEFT_MID, 10, 0);
+
+    // Level bar (right)
+    volume_bar = lv_bar_create(volume_panel);
+    lv_obj_set_size(volume_bar, 120, 8);
+    lv_obj_align(volume_bar, LV_ALIGN_RIGHT_MID, -10, 0);
+    lv_bar_set_range(volume_bar, 0, 100);
+    lv_obj_set_style_bg_color(volume_bar, lv_color_hex(0x333333), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(volume_bar, lv_color_hex(0x1db954), LV_PART_INDICATOR);
+    lv_obj_set_style_radius(volume_bar, 4, LV_PART_MAIN);
+    lv_obj_set_style_radius(volume_bar, 4, LV_PART_INDICATOR);
+
+    volume_timer = lv_timer_create(volume_timer_cb, VOLUME_FRAME_MS, NULL);
+    lv_timer_pause(volume_timer);
+}
+
+void lvgl_adjust_volume(int direction, uint16_t repeat)
+{
+    if (!volume_panel)
+        return;
+
+    if (targetVolume < 0)
+    {
+        targetVolume = VOLUME_DEFAULT;
+        displayedQ8 = VOLUME_DEFAULT << 8;
+    }
+
+    int step = min(1 + repeat / VOLUME_STEP_ACCEL_REPEATS, VOLUME_MAX_STEP);
+    int volume = constrain(targetVolume + direction * step, 0, 100);
+    lastLocalChangeMs = millis();
+    localChangeMade = true;
+
+    if (lv_obj_has_flag(volume_panel, LV_OBJ_FLAG_HIDDEN))
+    {
+        lv_obj_clear_flag(volume_panel, LV_OBJ_FLAG_HIDDEN);
+        lv_timer_resume(volume_timer);
+    }
+
+    if (volume == targetVolume)
+        return; // At a limit: the overlay still shows it
+
+    targetVolume = volume;
+    spotifyManager.requestVolume(volume);
+}
+
+// Adopt the player's volume from a playback state sample, unless the user just changed it here
+void lvgl_sync_volume(const SpotifyTrack &track, bool trackValid)
+{
+    if (!volume_panel || !trackValid || track.deviceName.length() == 0)
+        return;
+
+    if (localChangeMade && millis() - lastLocalChangeMs < VOLUME_REMOTE_HOLDOFF_MS)
+        return;
+
+    if (targetVolume < 0 || lv_obj_has_flag(volume_panel, LV_OBJ_FLAG_HIDDEN))
+    {
+        displayedQ8 = (int32_t)track.deviceVolume << 8;
+    }
+    targetVolume = track.deviceVolume;
+}
@@ -8,6 +8,7 @@
 #include <lvgl.h>
 
 #include "wifi_manager.h"
+#include "wifi_power.h"
 #include "config.h"
 #include "ui.h"
 #include "ui_setup.h"
@@ -15,7 +16,12 @@
 #include "lvgl_ui_components.h"
 #include "button.h"
 #include "audio_manager.h"
+#include "audio_stream_player.h"
+#include "audio_recorder.h"
+#include "clap_detector.h"
 #include "spotify_manager.h"
+#include "boot_timeline.h"
+#include <freertos/event_groups.h>
 
 // Manager objects
 WiFiManager wifiManager;
@@ -31,6 +37,7 @@ bool trackDataValid = false;
 // Forward declarations
 void forceSpotifyUpdate();
 void forceDisplayRefresh();
+void updateWifiStatusDisplay();
 
 // Simple states for Spotify player
 enum PlayerState
@@ -89,6 +96,9 @@ void updateSpotifyData()
         lvgl_update_track_info(emptyTrack, false);
     }
 
+    // Whatever the poll found (a track, an empty player or an error) is on screen now
+    boot_stage_end(BOOT_STAGE_FIRST_POLL);
+
     unsigned long elapsedTime = millis() - startTime;
     Serial0.printf("📊 Spotify update completed in %lu ms (success: %s)\n",
                    elapsedTime, success ? "YES" : "NO");
@@ -101,13 +111,106 @@ void forceSpotifyUpdate()
     lastSpotifyUpdate = millis(); // Reset timer to prevent immediate next update
 }
 
+// Mirror the WiFi state machine in the status bar (label only touched on change)
+void updateWifiStatusDisplay()
+{
+    static bool lastConnected = false;
+    static String lastStatus = "-";
+
+    bool connected = wifiManager.isConnected();
+    String status = wifiManager.getShortStatus();
+    if (connected != lastConnected || status != lastStatus)
+    {
+        lvgl_update_wifi_status(connected, status.c_str());
+        lastConnected = connected;
+        lastStatus = status;
+    }
+}
+
+// Boot stages that other stages wait for
+#define BOOT_AUDIO_READY BIT0
+#define BOOT_WIFI_READY BIT1
+#define BOOT_SPOTIFY_READY BIT2
+#define BOOT_TASK_CORE 0 // Core 1 builds the UI and runs the loop meanwhile
+
+static EventGroupHandle_t bootEvents;
+
+// Audio bring-up and the startup chime, concurrent with display/UI construction
+static void bootAudioTask(void *parameter)
+{
+    boot_stage_begin(BOOT_STAGE_AUDIO);
+    Serial0.println("Initializing audio system...");
+    bool audioReady = audioManager.init();
+    if (audioReady)
+    {
+        // Play startup sound (non-blocking, boot continues while it plays)
+        boot_stage_begin(BOOT_STAGE_CHIME);
+        audioManager.playEarcon(EARCON_STARTUP);
+
+        // Streaming playback pipeline (HTTP / LittleFS -> MP3/AAC -> mixer)
+        audioStreamPlayer.init();
+
+        // Microphone recorder (capture ring -> ADPCM/WAV -> LittleFS)
+        audioRecorder.init();
+
+        // Hands-free control from the microphone (double/triple clap)
+        clapDetector.init();
+    }
+    else
+    {
+        // No chime without audio: the timeline must not wait for one
+        boot_stage_skip(BOOT_STAGE_CHIME);
+    }
+    boot_stage_end(BOOT_STAGE_AUDIO);
+    xEventGroupSetBits(bootEvents, BOOT_AUDIO_READY);
+
+    if (audioReady)
+    {
+        while (audioManager.isPlaying())
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        boot_stage_end(BOOT_STAGE_CHIME);
+    }
+    vTaskDelete(NULL);
+}
+
+// Spotify token as soon as WiFi is up (the loop signals it), then the ready chime
+static void bootNetworkTask(void *parameter)
+{
+    xEventGroupWaitBits(bootEvents, BOOT_WIFI_READY, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    boot_stage_begin(BOOT_STAGE_TOKEN);
+    Serial0.println("Authenticating with Spotify...");
+    if (!spotifyManager.authenticate())
+    {
+        Serial0.println("Spotify authentication failed - will retry on the first request");
+    }
+    boot_stage_end(BOOT_STAGE_TOKEN);
+    boot_stage_begin(BOOT_STAGE_FIRST_POLL);
+    xEventGroupSetBits(bootEvents, BOOT_SPOTIFY_READY);
+
+    // Play ready sound
+    xEventGroupWaitBits(bootEvents, BOOT_AUDIO_READY, pdFALSE, pdTRUE, portMAX_DELAY);
+    currentState = PLAYER_READY;
+    Serial0.println("ESP32 Spotify Player ready!");
+    audioManager.playEarcon(EARCON_READY);
+
+    // Optional stream for testing the playback pipeline (e.g. a local http.server)
+    if (strlen(AUDIO_STREAM_TEST_URL) > 0)
+    {
+        audioStreamPlayer.playUrl(AUDIO_STREAM_TEST_URL);
+    }
+    vTaskDelete(NULL);
+}
+
 void setup()
 {
     Serial0.begin(115200);
-    delay(1000);
     Serial0.println("Starting ESP32 Spotify Music Player...");
 
     // Initialize NVS
+    boot_stage_begin(BOOT_STAGE_NVS);
     Serial0.println("Initializing NVS...");
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
@@ -118,102 +221,101 @@ void setup()
     }
     ESP_ERROR_CHECK(ret);
     Serial0.println("✅ NVS initialized successfully");
+    boot_stage_end(BOOT_STAGE_NVS);
+
+    // Start associating first: the WiFi state machine joins in the background
+    // while everything below runs (the loop picks up from there)
+    Serial0.println("Initializing WiFi manager...");
+    boot_stage_begin(BOOT_STAGE_WIFI);
+    wifiManager.connect();
+
+    // Locks and worker only, the network part runs in the boot network task
+    spotifyManager.init();
 
-    delay(1000);
+    bootEvents = xEventGroupCreate();
+    xTaskCreatePinnedToCore(bootAudioTask, "BootAudio", 8192, nullptr, 2, nullptr, BOOT_TASK_CORE);
+    xTaskCreatePinnedToCore(bootNetworkTask, "BootNet", 12288, nullptr, 1, nullptr, BOOT_TASK_CORE);
 
     // Initialize display
+    boot_stage_begin(BOOT_STAGE_DISPLAY);
     Serial0.println("Initializing display...");
     initTFT();
+    boot_stage_end(BOOT_STAGE_DISPLAY);
 
     // Initialize LVGL UI system
+    boot_stage_begin(BOOT_STAGE_UI);
     Serial0.println("Initializing LVGL UI system...");
     lvgl_ui_init();
-
-    // Initialize audio system
-    Serial0.println("Initializing audio system...");
-    if (audioManager.init())
-    {
-        // Play startup sound
-        audioManager.playBeep(800, 200);
-        delay(100);
-        audioManager.playBeep(1000, 200);
-        delay(100);
-        audioManager.playBeep(1200, 200);
-    }
+    boot_stage_end(BOOT_STAGE_UI);
 
     // Initialize buttons
+    boot_stage_begin(BOOT_STAGE_BUTTONS);
     Serial0.println("Initializing buttons...");
     initButtons();
+    boot_stage_end(BOOT_STAGE_BUTTONS);
 
-    // Initialize WiFi
-    Serial0.println("Initializing WiFi manager...");
-    if (!wifiManager.hasStoredCredentials())
-    {
-        Serial0.println("No stored WiFi credentials, starting SmartConfig...");
-        wifiManager.startSmartConfig();
-    }
-
-    // Wait for WiFi connection
-    Serial0.println("Waiting for WiFi connection...");
-    while (!wifiManager.isConnected())
-    {
-        wifiManager.update();
-        delay(1000);
-        Serial0.print(".");
-    }
-    Serial0.println();
-    Serial0.println("WiFi connected!");
-
-    // Initialize Spotify manager
-    Serial0.println("Initializing Spotify manager...");
-    if (spotifyManager.init())
-    {
-        Serial0.println("Spotify manager initialized successfully!");
-    }
-    else
-    {
-        Serial0.println("Spotify manager initialization failed - continuing in demo mode");
-    }
-
-    currentState = PLAYER_READY;
-    Serial0.println("ESP32 Spotify Player ready!");
-
-    // Play ready sound
-    audioManager.playBeep(1000, 100);
-    delay(50);
-    audioManager.playBeep(1200, 100);
-    delay(50);
-    audioManager.playBeep(1500, 200);
+    // The UI is interactive from here; WiFi, Spotify and audio finish in the background
+    Serial0.println("UI ready, finishing boot in the background");
 }
 
 void loop()
 {
     // Handle LVGL tasks first (critical for UI responsiveness)
-    lv_timer_handler();
+    uint32_t lvglIdleMs = lv_timer_handler();
 
     // Process any completed image downloads (non-blocking)
     lvgl_process_pending_images();
 
+    // Advance the locally interpolated progress bar (no network access)
+    lvgl_update_playback_progress();
+
+    // Patch the device list when a background revalidation completes
+    lvgl_process_device_updates();
+
     // Update buttons and handle Spotify controls (critical for user interaction)
     updateButtons();
     handleSpotifyControls();
 
-    // Update WiFi manager
+    // Clap patterns act like the corresponding main screen buttons
+    ClapPattern clap = clapDetector.takePattern();
+    if (clap != CLAP_NONE && currentScreen == SCREEN_MAIN)
+    {
+        if (clap == CLAP_DOUBLE)
+        {
+            Serial0.println("👏 Double clap: play/pause");
+            handlePlayPause();
+        }
+        else
+        {
+            Serial0.println("👏 Triple clap: next track");
+            handleNextTrack();
+        }
+    }
+
+    // Advance the WiFi state machine (never blocks) and show its status
     wifiManager.update();
+    updateWifiStatusDisplay();
+
+    // The first connection releases the boot network task (Spotify token)
+    EventBits_t bootBits = xEventGroupGetBits(bootEvents);
+    if (!(bootBits & BOOT_WIFI_READY) && wifiManager.isConnected())
+    {
+        boot_stage_end(BOOT_STAGE_WIFI);
+        xEventGroupSetBits(bootEvents, BOOT_WIFI_READY);
+    }
+    bool spotifyReady = bootBits & BOOT_SPOTIFY_READY;
 
     unsigned long now = millis();
 
-    // Update WiFi status in LVGL UI
-    static bool lastWifiStatus = false;
-    bool currentWifiStatus = wifiManager.isConnected();
-    if (currentWifiStatus != lastWifiStatus)
+    // Modem sleep between polls: the policy wakes the radio just before the next one
+    if (currentScreen == SCREEN_MAIN && spotifyReady)
     {
-        lvgl_update_wifi_status(currentWifiStatus);
-        lastWifiStatus = currentWifiStatus;
+        wifiPower.scheduleActivity(lastSpotifyUpdate + 3000);
     }
+    wifiPower.update(wifiManager.isConnected());
 
-    // Update Spotify data every 3 seconds - only on main screen
-    if (currentScreen == SCREEN_MAIN && now - lastSpotifyUpdate > 3000)
+    // Update Spotify data every 3 seconds - only on main screen, right away once the token is in
+    if (currentScreen == SCREEN_MAIN && spotifyReady && (lastSpotifyUpdate == 0 || now - lastSpotifyUpdate > 3000))
     {
         Serial0.println("⏰ Time for Spotify update...");
         lastSpotifyUpdate = now; // Set this FIRST to prevent multiple calls
@@ -237,6 +339,14 @@ void loop()
         }
     }
 
+    // Boot timeline once the first poll is on screen (or whatever finished by the timeout)
+    static bool bootTimelinePrinted = false;
+    if (!bootTimelinePrinted && (boot_timeline_complete() || now > BOOT_TIMELINE_TIMEOUT_MS))
+    {
+        bootTimelinePrinted = true;
+        boot_timeline_print();
+    }
+
     // Add heartbeat to show the loop is running
     static unsigned long lastHeartbeat = 0;
     if (now - lastHeartbeat > 10000)
@@ -245,5 +355,13 @@ void loop()
         Serial0.printf("💓 System running - Free heap: %d bytes\n", esp_get_free_heap_size());
     }
 
-    delay(30); // Reduced delay for better LVGL responsiveness
+    // The spectrum screen animates at 30+ FPS: wake up when LVGL next has work
+    if (currentScreen == SCREEN_SPECTRUM)
+    {
+        delay(min(lvglIdleMs, (uint32_t)30));
+    }
+    else
+    {
+        delay(30); // Reduced delay for better LVGL responsiveness
+    }
 }
\ No newline at end of file
@@ -1,48 +1,74 @@
 #include "spotify_manager.h"
+#include "wifi_power.h"
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 
 SpotifyManager spotifyManager;
 
+// ArduinoJson pool allocator for the external PSRAM
+struct SpiRamAllocator
+{
+    void *allocate(size_t size) { return heap_caps_malloc(size, MALLOC_CAP_SPIRAM); }
+    void deallocate(void *pointer) { heap_caps_free(pointer); }
+    void *reallocate(void *pointer, size_t newSize) { return heap_caps_realloc(pointer, newSize, MALLOC_CAP_SPIRAM); }
+};
+
+typedef BasicJsonDocument<SpiRamAllocator> SpiRamJsonDocument;
+
 SpotifyManager::SpotifyManager()
 {
     refreshToken = SPOTIFY_REFRESH_TOKEN;
     tokenExpiry = 0;
+    tokenMutex = NULL;
+    cacheMutex = NULL;
+    workerTask = NULL;
+    deviceRefreshRequested = false;
+    pendingVolume.store(-1);
+    lastVolumePutAt = 0;
+    volumeRequests = 0;
+    volumePuts = 0;
+    volumeRetries = 0;
+    deviceCacheGeneration = 0;
+    deviceCacheUpdatedAt = 0;
+    lastPlaybackDeviceActive = false;
 }
 
 bool SpotifyManager::init()
 {
     Serial0.println("Initializing Spotify Manager...");
 
-    // Skip actual initialization if refresh token is not set
-    if (String(SPOTIFY_REFRESH_TOKEN) == "your_refresh_token_here")
+    // Token and cache are shared with the background worker task
+    if (!tokenMutex)
     {
-        Serial0.println("⚠️ Spotify refresh token not configured - running in demo mode");
-        accessToken = "demo_token";
-        return true; // Return true to avoid blocking
+        tokenMutex = xSemaphoreCreateRecursiveMutex();
+        cacheMutex = xSemaphoreCreateMutex();
     }
+    startBackgroundWorker();
 
     // Configure SSL client properly
     client.setInsecure();     // Allow insecure connections for now
     client.setTimeout(15000); // 15 second timeout
+    return true;
+}
 
-    Serial0.println("Testing SSL connection to Spotify...");
-
-    // Test connection first
-    if (!client.connect("accounts.spotify.com", 443))
+// Network part of initialization, run once WiFi is up. The token request is
+// the connectivity test: a separate test connection would only add a TLS handshake.
+bool SpotifyManager::authenticate()
+{
+    // Skip actual initialization if refresh token is not set
+    if (String(SPOTIFY_REFRESH_TOKEN) == "your_refresh_token_here")
     {
-        Serial0.println("❌ Cannot connect to Spotify servers - check WiFi and firewall");
-        Serial0.println("Running in demo mode...");
+        Serial0.println("⚠️ Spotify refresh token not configured - running in demo mode");
         accessToken = "demo_token";
-        return true; // Continue in demo mode
+        return true; // Return true to avoid blocking
     }
 
-    Serial0.println("✅ SSL connection to Spotify successful");
-    client.stop(); // Close test connection
-
     // Get initial access token
     if (!refreshAccessToken())
     {
         Serial0.println("Failed to get initial Spotify access token - continuing anyway");
-        return true; // Don't block initialization
+        return false;
     }
 
     Serial0.println("Spotify Manager initialized successfully!");
@@ -50,6 +76,35 @@ bool SpotifyManager::init()
 }
 
 bool SpotifyManager::refreshAccessToken()
+{
+    // Serialize refreshes between the main loop and the background worker
+    xSemaphoreTakeRecursive(tokenMutex, portMAX_DELAY);
+    bool success = requestAccessToken();
+    xSemaphoreGiveRecursive(tokenMutex);
+    return success;
+}
+
+bool SpotifyManager::ensureAccessToken()
+{
+    xSemaphoreTakeRecursive(tokenMutex, portMAX_DELAY);
+    bool success = true;
+    if (millis() > tokenExpiry)
+    {
+        success = refreshAccessToken();
+    }
+    xSemaphoreGiveRecursive(tokenMutex);
+    return success;
+}
+
+String SpotifyManager::getAccessToken()
+{
+    xSemaphoreTakeRecursive(tokenMutex, portMAX_DELAY);
+    String token = accessToken;
+    xSemaphoreGiveRecursive(tokenMutex);
+    return token;
+}
+
+bool SpotifyManager::requestAccessToken()
 {
     Serial0.println("Refreshing Spotify access token...");
 
@@ -60,7 +115,9 @@ bool SpotifyManager::refreshAccessToken()
         return false;
     }
 
-    // Use HTTPClient for token refresh
+    // Use a dedicated HTTPClient, refreshes can come from either task
+    WiFiActivity radio;
+    HTTPClient http;
     http.begin("https://accounts.spotify.com/api/token");
 
     String credentials = String(SPOTIFY_CLIENT_ID) + ":" + String(SPOTIFY_CLIENT_SECRET);
@@ -122,12 +179,9 @@ bool SpotifyManager::getCurrentTrack(SpotifyTrack &track)
     }
 
     // Check if token needs refresh
-    if (millis() > tokenExpiry)
+    if (!ensureAccessToken())
     {
-        if (!refreshAccessToken())
-        {
-            return false;
-        }
+        return false;
     }
 
     String response;
@@ -169,6 +223,7 @@ bool SpotifyManager::getPlaybackState(SpotifyTrack &track)
         track.shuffleState = false;
         track.repeatState = "off";
         track.timestamp = millis();
+        track.sampledAtUs = esp_timer_get_time();
         track.deviceName = "Demo Device";
         track.deviceVolume = 75;
         track.deviceIsActive = true;
@@ -177,19 +232,20 @@ bool SpotifyManager::getPlaybackState(SpotifyTrack &track)
     }
 
     // Check if token needs refresh
-    if (millis() > tokenExpiry)
+    if (!ensureAccessToken())
     {
-        if (!refreshAccessToken())
-        {
-            return false;
-        }
+        return false;
     }
 
+    // Spotify's "timestamp" is wall-clock epoch ms of the last state change, not of
+    // progress_ms: anchor the sample half way through the round trip instead
     String response;
+    int64_t requestStartUs = esp_timer_get_time();
     if (!makeSpotifyRequest("/me/player", "GET", "", response))
     {
         return false;
     }
+    int64_t sampledAtUs = requestStartUs + (esp_timer_get_time() - requestStartUs) / 2;
 
     // Handle HTTP 204 (No Content) - means no music is currently playing
     if (response.length() == 0)
@@ -207,6 +263,7 @@ bool SpotifyManager::getPlaybackState(SpotifyTrack &track)
         track.shuffleState = false;
         track.repeatState = "off";
         track.timestamp = 0;
+        track.sampledAtUs = 0;
         track.deviceName = "";
         track.deviceVolume = 0;
         track.deviceIsActive = false;
@@ -214,7 +271,20 @@ bool SpotifyManager::getPlaybackState(SpotifyTrack &track)
         return true; // This is success - just no music playing
     }
 
-    return parsePlaybackState(response, track);
+    if (!parsePlaybackState(response, track))
+    {
+        return false;
+    }
+    track.sampledAtUs = sampledAtUs;
+
+    // Playback moved to another device or changed activity: revalidate device list
+    if (track.deviceName != lastPlaybackDevice || track.deviceIsActive != lastPlaybackDeviceActive)
+    {
+        lastPlaybackDevice = track.deviceName;
+        lastPlaybackDeviceActive = track.deviceIsActive;
+        requestDeviceRefresh();
+    }
+    return true;
 }
 
 bool SpotifyManager::play()
@@ -283,8 +353,14 @@ bool SpotifyManager::setVolume(int volume)
 }
 
 bool SpotifyManager::makeSpotifyRequest(const String &endpoint, const String &method, const String &body, String &response)
+{
+    return makeSpotifyRequest(http, endpoint, method, body, response);
+}
+
+bool SpotifyManager::makeSpotifyRequest(HTTPClient &http, const String &endpoint, const String &method, const String &body, String &response)
 {
     Serial0.println("Making Spotify API request to: " + endpoint);
+    WiFiActivity radio; // Out of modem sleep until the response is in
 
     // Add connection timeout and retry logic
     unsigned long startTime = millis();
@@ -296,7 +372,7 @@ bool SpotifyManager::makeSpotifyRequest(const String &endpoint, const String &me
     http.setConnectTimeout(5000); // 5 second connection timeout
 
     // Set headers
-    http.addHeader("Authorization", "Bearer " + accessToken);
+    http.addHeader("Authorization", "Bearer " + getAccessToken());
     http.addHeader("Accept", "application/json");
     http.addHeader("User-Agent", "ESP32-Spotify-Player/1.0");
 
@@ -411,6 +487,7 @@ bool SpotifyManager::parseCurrentTrack(const String &response, SpotifyTrack &tra
     track.isPlaying = false;
     track.trackId = "";
     track.imageUrl = "";
+    track.sampledAtUs = 0;
 
     // Check if there's an active item
     if ((*doc)["item"].isNull())
@@ -542,6 +619,7 @@ bool SpotifyManager::parsePlaybackState(const String &response, SpotifyTrack &tr
     track.shuffleState = false;
     track.repeatState = "off";
     track.timestamp = 0;
+    track.sampledAtUs = 0;
     track.deviceName = "";
     track.deviceVolume = 0;
     track.deviceIsActive = false;
@@ -736,75 +814,81 @@ String SpotifyManager::base64Encode(const String &str)
     return base64EncodeFixed(str);
 }
 
-bool SpotifyManager::getDevices(SpotifyDevice devices[], int maxDevices, int &deviceCount)
+bool SpotifyManager::getDevices(std::vector<SpotifyDevice> &devices)
+{
+    if (!fetchDevices(http, devices))
+    {
+        return false;
+    }
+    publishDevices(devices);
+    return true;
+}
+
+bool SpotifyManager::fetchDevices(HTTPClient &http, std::vector<SpotifyDevice> &devices)
 {
     Serial0.println("Getting Spotify devices...");
-    deviceCount = 0;
+    devices.clear();
 
     // Return demo data if not configured
     if (String(SPOTIFY_REFRESH_TOKEN) == "your_refresh_token_here")
     {
         // Demo devices
-        devices[0] = {"demo1", "ESP32 Player", "Computer", true, 75};
-        devices[1] = {"demo2", "iPhone", "Smartphone", false, 85};
-        devices[2] = {"demo3", "Living Room Speaker", "Speaker", false, 60};
-        deviceCount = 3;
+        devices.push_back({"demo1", "ESP32 Player", "Computer", true, 75});
+        devices.push_back({"demo2", "iPhone", "Smartphone", false, 85});
+        devices.push_back({"demo3", "Living Room Speaker", "Speaker", false, 60});
         return true;
     }
 
     // Check if token needs refresh
-    if (millis() > tokenExpiry)
+    if (!ensureAccessToken())
     {
-        if (!refreshAccessToken())
-        {
-            return false;
-        }
+        return false;
     }
 
     String response;
-    if (!makeSpotifyRequest("/me/player/devices", "GET", "", response))
+    if (!makeSpotifyRequest(http, "/me/player/devices", "GET", "", response))
     {
         return false;
     }
 
-    // Use PSRAM for JSON parsing
-    DynamicJsonDocument *doc = new (ps_malloc(8192)) DynamicJsonDocument(8192);
-    if (!doc)
+    // Parse into a PSRAM pool, sized from the response so long device lists fit
+    size_t docSize = max((size_t)8192, (size_t)response.length() * 2);
+    SpiRamJsonDocument doc(docSize);
+    if (doc.capacity() == 0)
     {
         Serial0.println("❌ Failed to allocate PSRAM for devices JSON parsing");
         return false;
     }
 
-    DeserializationError error = deserializeJson(*doc, response);
+    DeserializationError error = deserializeJson(doc, response);
     if (error != DeserializationError::Ok)
     {
         Serial0.printf("❌ JSON parse error: %s\n", error.c_str());
-        free(doc);
         return false;
     }
 
-    if (doc->containsKey("devices"))
+    if (doc.containsKey("devices"))
     {
-        JsonArray devicesArray = (*doc)["devices"];
-        deviceCount = min((int)devicesArray.size(), maxDevices);
+        JsonArray devicesArray = doc["devices"];
+        devices.reserve(devicesArray.size());
 
-        for (int i = 0; i < deviceCount; i++)
+        for (JsonObject device : devicesArray)
         {
-            JsonObject device = devicesArray[i];
-            devices[i].id = device["id"].as<String>();
-            devices[i].name = device["name"].as<String>();
-            devices[i].type = device["type"].as<String>();
-            devices[i].isActive = device["is_active"];
-            devices[i].volumePercent = device["volume_percent"];
+            SpotifyDevice entry;
+            entry.id = device["id"].as<String>();
+            entry.name = device["name"].as<String>();
+            entry.type = device["type"].as<String>();
+            entry.isActive = device["is_active"];
+            entry.volumePercent = device["volume_percent"];
 
             Serial0.printf("Device %d: %s (%s) - %s\n",
-                           i, devices[i].name.c_str(), devices[i].type.c_str(),
-                           devices[i].isActive ? "Active" : "Inactive");
+                           (int)devices.size(), entry.name.c_str(), entry.type.c_str(),
+                           entry.isActive ? "Active" : "Inactive");
+            devices.push_back(entry);
         }
     }
 
-    free(doc);
-    Serial0.printf("Found %d devices\n", deviceCount);
+    Serial0.printf("Found %d devices\n", (int)devices.size());
     return true;
 }
 
@@ -820,15 +904,10 @@ bool SpotifyManager::transferPlayback(const String &deviceId)
     }
 
     // Check if token needs refresh
-    if (millis() > tokenExpiry)
+    if (!ensureAccessToken())
     {
-        Serial0.println("🔄 Token expired, refreshing...");
-        if (!refreshAccessToken())
-        {
-            Serial0.println("❌ Failed to refresh token for transfer");
-            return false;
-        }
-        Serial0.println("✅ Token refreshed successfully");
+        Serial0.println("❌ Failed to refresh token for transfer");
+        return false;
     }
 
     // Create JSON body for transfer request
@@ -841,6 +920,7 @@ bool SpotifyManager::transferPlayback(const String &deviceId)
     if (success)
     {
         Serial0.println("✅ Transfer request completed successfully");
+        requestDeviceRefresh();
         if (response.length() > 0)
         {
             Serial0.printf("📋 Response: %s\n", response.c_str());
@@ -861,3 +941,167 @@ bool SpotifyManager::transferPlayback(const String &deviceId)
 
     return success;
 }
+
+// Device cache (stale-while-revalidate)
+void SpotifyManager::publishDevices(const std::vector<SpotifyDevice> &devices)
+{
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    cachedDevices = devices;
+    deviceCacheGeneration++;
+    deviceCacheUpdatedAt = millis();
+    xSemaphoreGive(cacheMutex);
+}
+
+uint32_t SpotifyManager::getCachedDevices(std::vector<SpotifyDevice> &devices)
+{
+    if (!cacheMutex)
+    {
+        devices.clear();
+        return 0;
+    }
+
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+    devices = cachedDevices;
+    uint32_t generation = deviceCacheGeneration;
+    xSemaphoreGive(cacheMutex);
+    return generation;
+}
+
+uint32_t SpotifyManager::getDeviceCacheGeneration()
+{
+    return deviceCacheGeneration;
+}
+
+void SpotifyManager::requestDeviceRefresh()
+{
+    if (workerTask)
+    {
+        deviceRefreshRequested = true;
+        xTaskNotifyGive(workerTask);
+    }
+}
+
+void SpotifyManager::requestVolume(int volume)
+{
+    // Overwrite any value still waiting: only the latest one is worth sending
+    pendingVolume.store(constrain(volume, 0, 100));
+    volumeRequests++;
+    if (workerTask)
+    {
+        xTaskNotifyGive(workerTask);
+    }
+}
+
+void SpotifyManager::sendPendingVolume(HTTPClient &http)
+{
+    int volume = pendingVolume.exchange(-1);
+    if (volume < 0)
+    {
+        return;
+    }
+
+    lastVolumePutAt = millis();
+    volumePuts++;
+    Serial0.printf("🔊 Sending volume %d%% (%lu requests sent for %lu changes)\n", volume,
+                   (unsigned long)volumePuts, (unsigned long)volumeRequests);
+
+    if (String(SPOTIFY_REFRESH_TOKEN) == "your_refresh_token_here")
+    {
+        return; // Demo mode
+    }
+
+    // The token may have expired since the last poll refreshed it
+    String response;
+    if (ensureAccessToken() &&
+        makeSpotifyRequest(http, "/me/player/volume?volume_percent=" + String(volume), "PUT", "", response))
+    {
+        volumeRetries = 0;
+        return;
+    }
+
+    // Put it back for the next interval, unless a newer value has taken its place
+    int expected = -1;
+    if (volumeRetries < VOLUME_PUT_RETRIES && pendingVolume.compare_exchange_strong(expected, volume))
+    {
+        volumeRetries++;
+        Serial0.printf("❌ Volume update failed, retrying (%u/%u)\n", volumeRetries, VOLUME_PUT_RETRIES);
+    }
+    else
+    {
+        volumeRetries = 0;
+        Serial0.println("❌ Volume update failed");
+    }
+}
+
+void SpotifyManager::startBackgroundWorker()
+{
+    if (workerTask)
+    {
+        return;
+    }
+
+    xTaskCreatePinnedToCore(
+        workerTaskFunction, // Task function
+        "SpotifyWorker",    // Task name
+        12288,              // Stack size (SSL)
+        this,               // Parameters
+        1,                  // Priority (lower than main loop)
+        &workerTask,        // Task handle
+        0                   // Core 0, main loop uses core 1
+    );
+}
+
+// Background worker: sends coalesced volume changes and revalidates the device
+// cache on demand or when the TTL expires, using its own HTTPClient so it
+// never blocks the UI loop
+void SpotifyManager::workerTaskFunction(void *parameter)
+{
+    SpotifyManager *self = (SpotifyManager *)parameter;
+    HTTPClient workerHttp;
+    std::vector<SpotifyDevice> devices;
+
+    for (;;)
+    {
+        // A waiting volume change wakes us when its rate limit interval ends
+        TickType_t wait = pdMS_TO_TICKS(DEVICE_CACHE_TTL_MS);
+        if (self->pendingVolume.load() >= 0)
+        {
+            long remaining = VOLUME_PUT_INTERVAL_MS - (long)(millis() - self->lastVolumePutAt);
+            wait = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            self->pendingVolume.store(-1);
+            continue;
+        }
+
+        // Volume first: the user is holding a button waiting to hear it
+        if (self->pendingVolume.load() >= 0 && millis() - self->lastVolumePutAt >= VOLUME_PUT_INTERVAL_MS)
+        {
+            self->sendPendingVolume(workerHttp);
+        }
+
+        bool requested = self->deviceRefreshRequested.exchange(false);
+
+        bool stale = self->deviceCacheGeneration == 0 ||
+                     millis() - self->deviceCacheUpdatedAt >= DEVICE_CACHE_TTL_MS;
+        if (!requested && !stale)
+        {
+            continue;
+        }
+
+        unsigned long start = millis();
+        if (self->fetchDevices(workerHttp, devices))
+        {
+            self->publishDevices(devices);
+            Serial0.printf("📱 Device cache revalidated in background (%d devices, %lu ms)\n",
+                           (int)devices.size(), millis() - start);
+        }
+        else
+        {
+            Serial0.println("❌ Background device refresh failed - keeping cached list");
+        }
+    }
+}
@@ -1,18 +1,111 @@
 #include "wifi_manager.h"
+#include "config.h"
+#include "wifi_power.h"
+#include <esp_wifi.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
+#include <sys/time.h>
 
 // ESP32-S3 DevKit C1 RGB LED pins
 #define RGB_LED_R 38
 #define RGB_LED_G 39
 #define RGB_LED_B 40
 
+// Upper bounds of the connect-time histogram buckets (the last one is open)
+static const unsigned long connectHistBoundsMs[WIFI_CONNECT_HIST_BUCKETS - 1] = {
+    250, 500, 1000, 2000, 4000, 8000, 16000};
+
+// System time: runs on the RTC timer, so unlike millis() it carries on across
+// software resets and deep sleep. Power-on and brownout restart it at zero.
+static int64_t system_time_us()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static bool system_time_survived_reset()
+{
+    switch (esp_reset_reason())
+    {
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_DEEPSLEEP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Radio side of the modem sleep policy
+static uint32_t wifi_power_clock_ms()
+{
+    return millis();
+}
+
+static void wifi_power_set_modem_sleep(bool doze)
+{
+    esp_wifi_set_ps(doze ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE);
+}
+
+static void wifi_power_log_stats(const WiFiPowerStats &stats)
+{
+    uint32_t total = max(stats.awakeMs + stats.dozeMs, (uint32_t)1);
+    Serial0.printf("📡 WiFi radio awake %lu ms/min (%lu%%), dozing %lu ms, wakes: %lu scheduled, %lu input, %lu traffic\n",
+                   (unsigned long)(stats.awakeMs * 60000ULL / total),
+                   (unsigned long)(stats.awakeMs * 100ULL / total), (unsigned long)stats.dozeMs,
+                   (unsigned long)stats.wakes[WIFI_WAKE_SCHEDULED], (unsigned long)stats.wakes[WIFI_WAKE_INPUT],
+                   (unsigned long)stats.wakes[WIFI_WAKE_TRAFFIC]);
+}
+
+// The doze listen interval is negotiated at association: call between
+// WiFi.begin(..., connect = false) and esp_wifi_connect()
+static void configure_listen_interval()
+{
+    wifi_config_t config;
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK)
+    {
+        config.sta.listen_interval = WIFI_POWER_LISTEN_INTERVAL;
+        esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+}
+
+// Lease time the DHCP client was granted on the station interface, 0 if not bound
+static uint32_t sta_lease_seconds()
+{
+    esp_netif_t *sta = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif *netif = sta ? (struct netif *)esp_netif_get_netif_impl(sta) : nullptr;
+    struct dhcp *dhcp = netif ? netif_dhcp_data(netif) : nullptr;
+    return dhcp && dhcp->state == DHCP_STATE_BOUND ? dhcp->offered_t0_lease : 0;
+}
+
 WiFiManager::WiFiManager()
 {
     _connected = false;
     _smartConfigActive = false;
-    _lastReconnectAttempt = 0;
+    _eventsRegistered = false;
+    _settingsLoaded = false;
+    _fastAttempt = false;
+    _staticLease = false;
+    _candidateCount = 0;
+    _nextCandidate = 0;
+    _attemptNetwork = -1;
+    _fastCacheValid = false;
+    _connectChainStart = 0;
+    _state = STATE_IDLE;
+    _source = SOURCE_STORED;
+    _stateStartTime = 0;
     _smartConfigStartTime = 0;
+    _eventGotIP = false;
+    _eventDisconnected = false;
+    _disconnectReason = 0;
     _smartConfigStatus = "Ready";
-    _preferences.begin("wifi", false);
+    memset(&_store, 0, sizeof(_store));
+    memset(&_fastCache, 0, sizeof(_fastCache));
+    memset(&_connectHist, 0, sizeof(_connectHist));
     
     // Initialize RGB LED pins
     pinMode(RGB_LED_R, OUTPUT);
@@ -52,57 +145,349 @@ void WiFiManager::setLEDStatus(LEDStatus status)
 
 bool WiFiManager::connect()
 {
-    setLEDStatus(LED_CONNECTING);
-    
-    // Only try stored credentials, no hardcoded fallback
-    if (hasStoredCredentials() && connectWithStoredCredentials())
+    loadSettings();
+    registerEvents();
+    _connectChainStart = millis();
+
+    if (hasStoredCredentials())
     {
-        setLEDStatus(LED_CONNECTED);
+        startConnecting();
         return true;
     }
 
-    // If no stored credentials, start SmartConfig automatically
+    // No known networks, start SmartConfig automatically
     Serial0.println("No stored WiFi credentials found. Starting SmartConfig...");
-    startSmartConfig();
-    return false;
+    return startSmartConfig();
 }
 
-bool WiFiManager::connectWithFallbackCredentials()
+void WiFiManager::loadSettings()
 {
-    Serial0.println("Attempting fallback WiFi connection...");
-    _smartConfigStatus = "Connecting to fallback WiFi...";
+    if (_settingsLoaded)
+    {
+        return;
+    }
+    _settingsLoaded = true;
+
+    // NVS is only ready once the Arduino core has started, not in the global constructor
+    _preferences.begin("wifi", false);
+
+    memset(&_store, 0, sizeof(_store));
+    if (_preferences.getBytesLength("networks") == sizeof(_store))
+    {
+        _preferences.getBytes("networks", &_store, sizeof(_store));
+        _store.count = min(_store.count, (uint8_t)WIFI_MAX_NETWORKS);
+    }
+
+    // Single pair written by earlier firmware
+    if (_preferences.isKey("ssid"))
+    {
+        addNetwork(_preferences.getString("ssid", ""), _preferences.getString("password", ""));
+        _preferences.remove("ssid");
+        _preferences.remove("password");
+    }
+
+    // Network from the build environment (.env), replaces the old hard-coded fallback
+#ifdef WIFI_SSID
+    if (strlen(WIFI_SSID) > 0)
+    {
+        addNetwork(WIFI_SSID, WIFI_PASSWORD);
+    }
+#endif
+
+    loadFastConnectCache();
+    memset(&_connectHist, 0, sizeof(_connectHist));
+    if (_preferences.getBytesLength("connhist") == sizeof(_connectHist))
+    {
+        _preferences.getBytes("connhist", &_connectHist, sizeof(_connectHist));
+    }
+
+    Serial0.printf("📶 %u known WiFi network(s)\n", _store.count);
+    for (uint8_t i = 0; i < _store.count; i++)
+    {
+        const WiFiNetworkRecord &net = _store.networks[i];
+        Serial0.printf("   %s: %u joined, %u failed\n", net.ssid, net.successes, net.failures);
+    }
+}
+
+void WiFiManager::registerEvents()
+{
+    if (_eventsRegistered)
+    {
+        return;
+    }
+
+    // Events arrive on the WiFi event task; update() acts on them from the loop
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info)
+                 { onWiFiEvent(event, info); });
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false); // Retries are driven by the state machine
+    wifiPower.begin({wifi_power_clock_ms, wifi_power_set_modem_sleep, wifi_power_log_stats});
+    _eventsRegistered = true;
+}
+
+void WiFiManager::onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+    switch (event)
+    {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        _eventGotIP = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        _disconnectReason = info.wifi_sta_disconnected.reason;
+        _eventDisconnected = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        _disconnectReason = 0;
+        _eventDisconnected = true;
+        break;
+    default:
+        break;
+    }
+}
+
+void WiFiManager::setState(ConnectionState state)
+{
+    _state = state;
+    _stateStartTime = millis();
+}
+
+// Directed join to the last AP if it is still a known network, otherwise one ranking scan
+void WiFiManager::startConnecting()
+{
+    _connected = false;
     setLEDStatus(LED_CONNECTING);
-    
-    WiFi.begin("Thean Room 2.4", "Thean016");
-    
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < 15000) // 15 second timeout
+    if (!beginFastAttempt())
     {
-        delay(500);
-        Serial0.print(".");
+        startScan();
     }
-    
-    if (WiFi.status() == WL_CONNECTED)
-    {
-        _connected = true;
-        _smartConfigStatus = "Connected to fallback WiFi";
-        setLEDStatus(LED_CONNECTED);
-        Serial0.println("");
-        Serial0.println("WiFi connected with fallback credentials");
-        Serial0.print("IP address: ");
-        Serial0.println(WiFi.localIP());
-        
-        // Save fallback credentials for future use
-        saveCredentials("Thean Room 2.4", "Thean016");
-        return true;
+}
+
+bool WiFiManager::beginFastAttempt()
+{
+    int network = _fastCacheValid ? findNetwork(_fastCache.ssid) : -1;
+    if (network < 0)
+    {
+        return false;
+    }
+
+    // No scan, straight to the cached AP on its channel, and no DHCP round
+    // while the cached lease is before its renewal time
+    int32_t renewIn = leaseSecondsToRenewal();
+    bool reuseLease = renewIn > 0;
+    char lease[48];
+    if (reuseLease)
+    {
+        snprintf(lease, sizeof(lease), "%s (renewal in %lds)", IPAddress(_fastCache.ip).toString().c_str(),
+                 (long)renewIn);
     }
     else
     {
-        Serial0.println("");
-        Serial0.println("Failed to connect with fallback credentials");
-        _smartConfigStatus = "Fallback connection failed";
-        setLEDStatus(LED_ERROR);
-        return false;
+        snprintf(lease, sizeof(lease), "DHCP");
+    }
+    Serial0.printf("Fast connect: BSSID %02X:%02X:%02X:%02X:%02X:%02X, channel %u, %s\n",
+                   _fastCache.bssid[0], _fastCache.bssid[1], _fastCache.bssid[2],
+                   _fastCache.bssid[3], _fastCache.bssid[4], _fastCache.bssid[5],
+                   _fastCache.channel, lease);
+
+    _fastAttempt = true;
+    joinNetwork(network, _fastCache.channel, _fastCache.bssid, reuseLease);
+    return true;
+}
+
+void WiFiManager::startScan()
+{
+    Serial0.println("Scanning for known WiFi networks...");
+    _fastAttempt = false;
+    _smartConfigStatus = "Scanning...";
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    WiFi.scanDelete();
+    WiFi.scanNetworks(true); // Async: update() polls scanComplete()
+    setState(STATE_SCANNING);
+}
+
+void WiFiManager::rankCandidates(int16_t found)
+{
+    _candidateCount = 0;
+    _nextCandidate = 0;
+
+    // Strongest AP per known SSID
+    for (int16_t i = 0; i < found; i++)
+    {
+        int network = findNetwork(WiFi.SSID(i).c_str());
+        if (network < 0)
+        {
+            continue;
+        }
+
+        Candidate *candidate = nullptr;
+        for (uint8_t c = 0; c < _candidateCount; c++)
+        {
+            if (_candidates[c].network == network)
+            {
+                candidate = &_candidates[c];
+            }
+        }
+        if (!candidate)
+        {
+            candidate = &_candidates[_candidateCount++];
+            candidate->network = network;
+            candidate->rssi = INT8_MIN;
+        }
+        if (WiFi.RSSI(i) > candidate->rssi)
+        {
+            candidate->rssi = WiFi.RSSI(i);
+            candidate->channel = WiFi.channel(i);
+            memcpy(candidate->bssid, WiFi.BSSID(i), sizeof(candidate->bssid));
+        }
+    }
+    WiFi.scanDelete();
+
+    // Signal plus history: the smoothed join rate is worth up to
+    // WIFI_HISTORY_WEIGHT_DB (an untried network gets half)
+    for (uint8_t c = 0; c < _candidateCount; c++)
+    {
+        const WiFiNetworkRecord &net = _store.networks[_candidates[c].network];
+        int history = WIFI_HISTORY_WEIGHT_DB * (net.successes + 1) / (net.successes + net.failures + 2);
+        bool lastUsed = net.lastSuccess != 0 && net.lastSuccess == _store.connectSequence;
+        _candidates[c].score = _candidates[c].rssi + history + (lastUsed ? WIFI_LAST_USED_BONUS_DB : 0);
+    }
+
+    // Insertion sort, best score first
+    for (uint8_t c = 1; c < _candidateCount; c++)
+    {
+        Candidate key = _candidates[c];
+        int j = c - 1;
+        while (j >= 0 && _candidates[j].score < key.score)
+        {
+            _candidates[j + 1] = _candidates[j];
+            j--;
+        }
+        _candidates[j + 1] = key;
+    }
+
+    Serial0.printf("📶 Scan found %d APs, %u known network(s) in range\n", found, _candidateCount);
+    for (uint8_t c = 0; c < _candidateCount; c++)
+    {
+        Serial0.printf("   %u. %s (%d dBm, channel %u, score %d)\n", c + 1,
+                       _store.networks[_candidates[c].network].ssid,
+                       _candidates[c].rssi, _candidates[c].channel, _candidates[c].score);
+    }
+}
+
+void WiFiManager::beginNextCandidate()
+{
+    if (_nextCandidate >= _candidateCount)
+    {
+        Serial0.println("No known network could be joined. Starting SmartConfig...");
+        _smartConfigStatus = "No known network, starting SmartConfig";
+        startSmartConfig();
+        return;
+    }
+
+    // Directed to the AP the scan picked, so the join doesn't scan again
+    const Candidate &candidate = _candidates[_nextCandidate++];
+    joinNetwork(candidate.network, candidate.channel, candidate.bssid, false);
+}
+
+// Directed join to one AP of a stored network, with DHCP or the cached lease
+void WiFiManager::joinNetwork(int network, uint8_t channel, const uint8_t *bssid, bool staticLease)
+{
+    const WiFiNetworkRecord &net = _store.networks[network];
+    Serial0.printf("Connecting to %s (channel %u)...\n", net.ssid, channel);
+
+    _source = SOURCE_STORED;
+    _attemptNetwork = network;
+    _attemptSSID = net.ssid;
+    _smartConfigStatus = "Connecting to " + _attemptSSID;
+    setLEDStatus(LED_CONNECTING);
+
+    _eventGotIP = false;
+    _eventDisconnected = false;
+    _staticLease = staticLease;
+    WiFi.mode(WIFI_STA);
+    if (staticLease)
+    {
+        WiFi.config(IPAddress(_fastCache.ip), IPAddress(_fastCache.gateway),
+                    IPAddress(_fastCache.subnet), IPAddress(_fastCache.dns));
+    }
+    else
+    {
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
+    // Configure without connecting, so the doze listen interval is part of the association
+    WiFi.begin(net.ssid, net.password, channel, bssid, false);
+    configure_listen_interval();
+    esp_wifi_connect();
+    setState(STATE_CONNECTING);
+}
+
+void WiFiManager::attemptFailed(const char *why)
+{
+    Serial0.printf("WiFi connection to %s failed (%s)\n", _attemptSSID.c_str(), why);
+    setLEDStatus(LED_ERROR);
+    WiFi.disconnect();
+
+    if (_fastAttempt)
+    {
+        // The AP moved, changed channel or the lease is gone: scan instead.
+        // Not held against the network, the scan will show whether it is there.
+        Serial0.println("Fast connect failed, falling back to a scan");
+        clearFastConnectCache();
+        startScan();
+        return;
+    }
+
+    if (_source == SOURCE_SMARTCONFIG)
+    {
+        // Give the AP a moment, then look for known networks again
+        Serial0.println("Failed to connect after SmartConfig. Retrying known networks...");
+        _smartConfigStatus = "SmartConfig failed";
+        stopSmartConfig();
+        setState(STATE_RETRY_WAIT);
+        return;
+    }
+
+    // Keep the credentials, count the failure, try the next network in range
+    recordResult(_attemptNetwork, false);
+    beginNextCandidate();
+}
+
+void WiFiManager::onConnected()
+{
+    _connected = true;
+    setState(STATE_CONNECTED);
+    setLEDStatus(LED_CONNECTED);
+
+    if (_source == SOURCE_SMARTCONFIG)
+    {
+        Serial0.println("WiFi connected via SmartConfig");
+        stopSmartConfig();
+        WiFi.mode(WIFI_STA);
+
+        // Remember the new network alongside the others
+        addNetwork(WiFi.SSID(), WiFi.psk());
+        _attemptNetwork = findNetwork(WiFi.SSID().c_str());
+    }
+    else
+    {
+        Serial0.printf("WiFi connected to known network %s\n", _attemptSSID.c_str());
+        recordConnectTime(millis() - _connectChainStart, _fastAttempt);
+    }
+    _smartConfigStatus = "Connected to " + WiFi.SSID();
+    Serial0.print("SSID: ");
+    Serial0.println(WiFi.SSID());
+    Serial0.print("IP address: ");
+    Serial0.println(WiFi.localIP());
+
+    if (_attemptNetwork >= 0)
+    {
+        recordResult(_attemptNetwork, true);
+    }
+
+    if (!_staticLease)
+    {
+        saveFastConnectCache(); // Fresh BSSID, channel and DHCP lease
     }
 }
 
@@ -113,18 +498,24 @@ bool WiFiManager::startSmartConfig()
         return false; // Already active
     }
 
+    loadSettings();
+    registerEvents();
     Serial0.println("Starting SmartConfig...");
     WiFi.mode(WIFI_AP_STA);
     WiFi.beginSmartConfig();
 
+    _connected = false;
     _smartConfigActive = true;
     _smartConfigStartTime = millis();
     _smartConfigStatus = "Waiting for ESP Touch app...";
+    _eventGotIP = false;
+    _eventDisconnected = false;
+    setState(STATE_SMARTCONFIG);
     setLEDStatus(LED_SMARTCONFIG);
 
     Serial0.println("SmartConfig started. Use ESP Touch app to configure WiFi.");
     Serial0.println("Download 'ESP Touch' or 'ESP32 SmartConfig' app on your phone.");
-    Serial0.println("Will fallback to default WiFi after 20 seconds...");
+    Serial0.println("Will retry known networks after 20 seconds...");
     return true;
 }
 
@@ -149,11 +540,11 @@ String WiFiManager::getSmartConfigStatus()
     if (_smartConfigActive)
     {
         unsigned long elapsed = millis() - _smartConfigStartTime;
-        unsigned long remaining = (20000 - elapsed) / 1000; // Changed to 20 seconds
-        if (remaining > 0) {
-            return "Waiting... " + String(remaining) + "s left (then fallback)";
+        if (elapsed < _smartConfigTimeout) {
+            unsigned long remaining = (_smartConfigTimeout - elapsed) / 1000;
+            return "Waiting... " + String(remaining) + "s left (then retry)";
         } else {
-            return "Switching to fallback WiFi...";
+            return "Retrying known networks...";
         }
     }
     return _smartConfigStatus;
@@ -161,59 +552,130 @@ String WiFiManager::getSmartConfigStatus()
 
 bool WiFiManager::hasStoredCredentials()
 {
-    return _preferences.isKey("ssid") && _preferences.isKey("password");
+    loadSettings();
+    return _store.count > 0;
 }
 
 void WiFiManager::clearStoredCredentials()
 {
-    _preferences.remove("ssid");
-    _preferences.remove("password");
+    loadSettings();
+    _store.count = 0;
+    saveStore();
+    clearFastConnectCache();
     Serial0.println("Stored WiFi credentials cleared");
     _smartConfigStatus = "Credentials cleared";
 }
 
-bool WiFiManager::connectWithStoredCredentials()
+// Adds a network or updates its password; a full store drops its least useful entry
+bool WiFiManager::addNetwork(const String &ssid, const String &password)
 {
-    String ssid, password;
-    if (!loadCredentials(ssid, password))
+    loadSettings();
+    if (ssid.isEmpty() || ssid.length() >= sizeof(_store.networks[0].ssid) ||
+        password.length() >= sizeof(_store.networks[0].password))
     {
         return false;
     }
 
-    Serial0.print("Connecting with stored credentials to: ");
-    Serial0.println(ssid);
-    _smartConfigStatus = "Connecting to " + ssid;
-    setLEDStatus(LED_CONNECTING);
+    int network = findNetwork(ssid.c_str());
+    if (network >= 0)
+    {
+        if (password == _store.networks[network].password)
+        {
+            return true;
+        }
+    }
+    else if (_store.count < WIFI_MAX_NETWORKS)
+    {
+        network = _store.count++;
+        memset(&_store.networks[network], 0, sizeof(WiFiNetworkRecord));
+    }
+    else
+    {
+        // Evict the network that was joined longest ago (never-joined ones first)
+        network = 0;
+        for (uint8_t i = 1; i < _store.count; i++)
+        {
+            if (_store.networks[i].lastSuccess < _store.networks[network].lastSuccess)
+            {
+                network = i;
+            }
+        }
+        Serial0.printf("WiFi store full, forgetting %s\n", _store.networks[network].ssid);
+        memset(&_store.networks[network], 0, sizeof(WiFiNetworkRecord));
+    }
 
-    WiFi.begin(ssid.c_str(), password.c_str());
+    WiFiNetworkRecord &net = _store.networks[network];
+    strncpy(net.ssid, ssid.c_str(), sizeof(net.ssid) - 1);
+    strncpy(net.password, password.c_str(), sizeof(net.password) - 1);
+    saveStore();
+    Serial0.printf("WiFi network %s saved to flash memory\n", net.ssid);
+    return true;
+}
 
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < 15000) // 15 second timeout
+bool WiFiManager::forgetNetwork(const String &ssid)
+{
+    loadSettings();
+    int network = findNetwork(ssid.c_str());
+    if (network < 0)
     {
-        delay(500);
-        Serial0.print(".");
+        return false;
     }
 
-    if (WiFi.status() == WL_CONNECTED)
+    for (uint8_t i = network; i + 1 < _store.count; i++)
     {
-        _connected = true;
-        _smartConfigStatus = "Connected to " + ssid;
-        setLEDStatus(LED_CONNECTED);
-        Serial0.println("");
-        Serial0.println("WiFi connected with stored credentials");
-        Serial0.print("IP address: ");
-        Serial0.println(WiFi.localIP());
-        return true;
+        _store.networks[i] = _store.networks[i + 1];
+    }
+    _store.count--;
+    saveStore();
+    if (_fastCacheValid && ssid == _fastCache.ssid)
+    {
+        clearFastConnectCache();
+    }
+    return true;
+}
+
+uint8_t WiFiManager::getNetworkCount()
+{
+    loadSettings();
+    return _store.count;
+}
+
+int WiFiManager::findNetwork(const char *ssid)
+{
+    for (uint8_t i = 0; i < _store.count; i++)
+    {
+        if (strcmp(_store.networks[i].ssid, ssid) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void WiFiManager::recordResult(int network, bool success)
+{
+    WiFiNetworkRecord &net = _store.networks[network];
+    if (success)
+    {
+        net.successes++;
+        net.lastSuccess = ++_store.connectSequence;
     }
     else
     {
-        Serial0.println("");
-        Serial0.println("Failed to connect with stored credentials. Clearing them.");
-        clearStoredCredentials();
-        _smartConfigStatus = "Connection failed, starting SmartConfig";
-        setLEDStatus(LED_ERROR);
-        return false;
+        net.failures++;
     }
+
+    if (net.successes + net.failures >= WIFI_HISTORY_DECAY_AT)
+    {
+        net.successes /= 2;
+        net.failures /= 2;
+    }
+    saveStore();
+}
+
+void WiFiManager::saveStore()
+{
+    _preferences.putBytes("networks", &_store, sizeof(_store));
 }
 
 void WiFiManager::disconnect()
@@ -221,6 +683,7 @@ void WiFiManager::disconnect()
     stopSmartConfig();
     WiFi.disconnect();
     _connected = false;
+    setState(STATE_IDLE);
     _smartConfigStatus = "Disconnected";
     setLEDStatus(LED_OFF);
     Serial0.println("WiFi disconnected");
@@ -228,107 +691,99 @@ void WiFiManager::disconnect()
 
 void WiFiManager::update()
 {
-    // Handle SmartConfig
-    if (_smartConfigActive)
+    unsigned long now = millis();
+
+    switch (_state)
     {
-        // Check for 20-second timeout to fallback
-        if (millis() - _smartConfigStartTime > 20000) // Changed to 20 seconds
+    case STATE_IDLE:
+        break;
+
+    case STATE_SCANNING:
+    {
+        int16_t found = WiFi.scanComplete();
+        if (found == WIFI_SCAN_RUNNING && now - _stateStartTime < WIFI_SCAN_TIMEOUT_MS)
         {
-            Serial0.println("SmartConfig timeout after 20 seconds. Trying fallback credentials...");
-            stopSmartConfig();
-            
-            if (connectWithFallbackCredentials())
-            {
-                return; // Successfully connected with fallback
-            }
-            else
-            {
-                // If fallback fails, restart SmartConfig
-                Serial0.println("Fallback failed. Restarting SmartConfig...");
-                delay(1000);
-                startSmartConfig();
-                return;
-            }
+            break;
         }
+        rankCandidates(max(found, (int16_t)0));
+        beginNextCandidate();
+        break;
+    }
+
+    case STATE_CONNECTING:
+    {
+        bool gotIP = _eventGotIP.exchange(false);
+        bool disconnected = _eventDisconnected.exchange(false);
+        uint8_t reason = _disconnectReason;
 
-        // Check if SmartConfig is done
+        if (gotIP || WiFi.status() == WL_CONNECTED)
+        {
+            onConnected();
+        }
+        else if (disconnected && reason != WIFI_REASON_ASSOC_LEAVE)
+        {
+            // ASSOC_LEAVE is our own disconnect from before WiFi.begin()
+            char why[32];
+            snprintf(why, sizeof(why), "reason %u", reason);
+            attemptFailed(why);
+        }
+        else if (now - _stateStartTime > (_fastAttempt ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_TIMEOUT))
+        {
+            attemptFailed("timeout");
+        }
+        break;
+    }
+
+    case STATE_CONNECTED:
+        if (_eventDisconnected.exchange(false))
+        {
+            Serial0.printf("WiFi disconnected (reason %u), attempting to reconnect...\n",
+                           (unsigned)_disconnectReason);
+            _connected = false;
+            setLEDStatus(LED_ERROR);
+            _connectChainStart = now;
+
+            // Last AP first, then the known networks in range, then SmartConfig
+            startConnecting();
+        }
+        else if (_staticLease && leaseSecondsToRenewal() <= 0)
+        {
+            renewLease();
+        }
+        else if (_eventGotIP.exchange(false) && !_staticLease)
+        {
+            saveFastConnectCache(); // Lease renewed in place
+        }
+        break;
+
+    case STATE_SMARTCONFIG:
         if (WiFi.smartConfigDone())
         {
+            // The WiFi library has already started joining the received network
             Serial0.println("SmartConfig received.");
             _smartConfigStatus = "Credentials received, connecting...";
+            _source = SOURCE_SMARTCONFIG;
+            _attemptNetwork = -1;
+            _fastAttempt = false;
+            _attemptSSID = WiFi.SSID();
+            setState(STATE_CONNECTING);
             setLEDStatus(LED_CONNECTING);
-
-            // Wait for WiFi to connect
-            Serial0.println("Waiting for WiFi connection...");
-            unsigned long startTime = millis();
-            while (WiFi.status() != WL_CONNECTED && millis() - startTime < 15000)
-            {
-                delay(500);
-                Serial0.print(".");
-            }
-
-            if (WiFi.status() == WL_CONNECTED)
-            {
-                Serial0.println("");
-                Serial0.println("WiFi connected via SmartConfig");
-                Serial0.print("SSID: ");
-                Serial0.println(WiFi.SSID());
-                Serial0.print("IP: ");
-                Serial0.println(WiFi.localIP());
-
-                // Save the new credentials
-                saveCredentials(WiFi.SSID(), WiFi.psk());
-                _connected = true;
-                _smartConfigStatus = "Connected to " + WiFi.SSID();
-                setLEDStatus(LED_CONNECTED);
-            }
-            else
-            {
-                Serial0.println("");
-                Serial0.println("Failed to connect after SmartConfig. Trying fallback...");
-                _smartConfigStatus = "SmartConfig failed, trying fallback...";
-                setLEDStatus(LED_ERROR);
-                
-                if (!connectWithFallbackCredentials())
-                {
-                    delay(2000);
-                    startSmartConfig(); // Restart SmartConfig if fallback also fails
-                    return;
-                }
-            }
-
+        }
+        else if (now - _smartConfigStartTime > _smartConfigTimeout)
+        {
+            Serial0.println("SmartConfig timeout after 20 seconds. Retrying known networks...");
             stopSmartConfig();
-            return;
+            setState(STATE_RETRY_WAIT);
         }
-    }
-
-    // Regular WiFi status check
-    if (WiFi.status() != WL_CONNECTED)
-    {
-        _connected = false;
-        setLEDStatus(LED_ERROR);
+        break;
 
-        // Try to reconnect if enough time has passed since last attempt
-        unsigned long currentTime = millis();
-        if (currentTime - _lastReconnectAttempt > _reconnectInterval)
+    case STATE_RETRY_WAIT:
+        if (now - _stateStartTime > _retryDelay)
         {
-            _lastReconnectAttempt = currentTime;
-            Serial0.println("WiFi disconnected, attempting to reconnect...");
-
-            // Try stored credentials first, then fallback, then SmartConfig
-            if (!connectWithStoredCredentials())
-            {
-                if (!connectWithFallbackCredentials())
-                {
-                    startSmartConfig();
-                }
-            }
+            _connectChainStart = now;
+            startConnecting();
         }
-    }
-    else
-    {
-        _connected = true;
-        setLEDStatus(LED_CONNECTED);
+        break;
     }
 }
 
@@ -337,6 +792,33 @@ bool WiFiManager::isConnected()
     return _connected;
 }
 
+WiFiManager::ConnectionState WiFiManager::getState()
+{
+    return _state;
+}
+
+String WiFiManager::getShortStatus()
+{
+    unsigned long elapsed = (millis() - _stateStartTime) / 1000;
+
+    switch (_state)
+    {
+    case STATE_SCANNING:
+        return "Scan";
+    case STATE_CONNECTING:
+        return "Join " + String(elapsed) + "s";
+    case STATE_SMARTCONFIG:
+        return "Pair " + String(_smartConfigTimeout / 1000 - min(elapsed, _smartConfigTimeout / 1000)) + "s";
+    case STATE_RETRY_WAIT:
+        return "Retry";
+    case STATE_IDLE:
+        return "Off";
+    case STATE_CONNECTED:
+    default:
+        return "";
+    }
+}
+
 int WiFiManager::getRSSI()
 {
     if (_connected)
@@ -369,22 +851,108 @@ String WiFiManager::getSSID()
     return "Not connected";
 }
 
-void WiFiManager::saveCredentials(String ssid, String password)
+void WiFiManager::loadFastConnectCache()
+{
+    _fastCacheValid = _preferences.getBytesLength("fastconn") == sizeof(_fastCache) &&
+                      _preferences.getBytes("fastconn", &_fastCache, sizeof(_fastCache)) == sizeof(_fastCache) &&
+                      _fastCache.channel != 0;
+    _fastCache.ssid[sizeof(_fastCache.ssid) - 1] = '\0';
+
+    // The clock the lease age is measured on restarted: its age is unknown.
+    // Persisted, so a later software reset doesn't compare against the old epoch.
+    if (_fastCacheValid && _fastCache.leaseSeconds != 0 && !system_time_survived_reset())
+    {
+        _fastCache.leaseSeconds = 0;
+        _preferences.putBytes("fastconn", &_fastCache, sizeof(_fastCache));
+    }
+}
+
+void WiFiManager::saveFastConnectCache()
 {
-    _preferences.putString("ssid", ssid);
-    _preferences.putString("password", password);
-    Serial0.println("WiFi credentials saved to flash memory");
+    memset(&_fastCache, 0, sizeof(_fastCache));
+    strncpy(_fastCache.ssid, WiFi.SSID().c_str(), sizeof(_fastCache.ssid) - 1);
+    memcpy(_fastCache.bssid, WiFi.BSSID(), sizeof(_fastCache.bssid));
+    _fastCache.channel = WiFi.channel();
+    _fastCache.ip = WiFi.localIP();
+    _fastCache.gateway = WiFi.gatewayIP();
+    _fastCache.subnet = WiFi.subnetMask();
+    _fastCache.dns = WiFi.dnsIP(0);
+    _fastCache.leaseObtainedUs = system_time_us();
+    _fastCache.leaseSeconds = sta_lease_seconds();
+    _fastCacheValid = _preferences.putBytes("fastconn", &_fastCache, sizeof(_fastCache)) == sizeof(_fastCache);
 }
 
-bool WiFiManager::loadCredentials(String &ssid, String &password)
+void WiFiManager::clearFastConnectCache()
 {
-    if (!hasStoredCredentials())
+    if (_fastCacheValid)
     {
-        return false;
+        _preferences.remove("fastconn");
+        _fastCacheValid = false;
     }
+}
 
-    ssid = _preferences.getString("ssid", "");
-    password = _preferences.getString("password", "");
+int32_t WiFiManager::leaseSecondsToRenewal()
+{
+    int64_t ageUs = system_time_us() - _fastCache.leaseObtainedUs;
+    if (!_fastCacheValid || _fastCache.leaseSeconds == 0 || ageUs < 0)
+    {
+        return -1;
+    }
+    int64_t renewIn = _fastCache.leaseSeconds / 2 - ageUs / 1000000;
+    return (int32_t)min(renewIn, (int64_t)INT32_MAX);
+}
 
-    return !ssid.isEmpty() && !password.isEmpty();
-}
\ No newline at end of file
+// A connection on the cached lease outlived its renewal time: hand the
+// interface to the DHCP client, which asks the server for a fresh lease
+void WiFiManager::renewLease()
+{
+    Serial0.println("Cached DHCP lease is due for renewal, starting the DHCP client");
+    _staticLease = false;
+    _eventGotIP = false;
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+}
+
+void WiFiManager::recordConnectTime(unsigned long ms, bool fast)
+{
+    uint8_t bucket = 0;
+    while (bucket < WIFI_CONNECT_HIST_BUCKETS - 1 && ms >= connectHistBoundsMs[bucket])
+    {
+        bucket++;
+    }
+
+    uint16_t *counts = fast ? _connectHist.fast : _connectHist.full;
+    if (counts[bucket] < UINT16_MAX)
+    {
+        counts[bucket]++;
+    }
+    _preferences.putBytes("connhist", &_connectHist, sizeof(_connectHist));
+
+    Serial0.printf("📶 Connected in %lu ms (%s)\n", ms, fast ? "fast reconnect" : "full scan");
+    printConnectStats();
+}
+
+void WiFiManager::printConnectStats()
+{
+    const uint16_t *rows[2] = {_connectHist.fast, _connectHist.full};
+    const char *names[2] = {"fast", "full"};
+
+    for (int row = 0; row < 2; row++)
+    {
+        char line[160];
+        int len = snprintf(line, sizeof(line), "📊 WiFi connect %s:", names[row]);
+        for (int i = 0; i < WIFI_CONNECT_HIST_BUCKETS && len < (int)sizeof(line); i++)
+        {
+            if (i < WIFI_CONNECT_HIST_BUCKETS - 1)
+            {
+                len += snprintf(line + len, sizeof(line) - len, " <%lu:%u",
+                                connectHistBoundsMs[i], rows[row][i]);
+            }
+            else
+            {
+                len += snprintf(line + len, sizeof(line) - len, " >=%lu:%u",
+                                connectHistBoundsMs[i - 1], rows[row][i]);
+            }
+        }
+        Serial0.println(line);
+    }
+}
@@ -0,0 +1,154 @@
+#include "wifi_power.h"
+#include <string.h>
+
+WiFiPowerPolicy wifiPower;
+
+WiFiPowerPolicy::WiFiPowerPolicy()
+    : started(false), dozing(false), activeRequests(0), awakeUntil(0), nextActivityAt(0),
+      activityScheduled(false), wasConnected(false), lastAccountMs(0), statsStartMs(0)
+{
+    memset(&hooks, 0, sizeof(hooks));
+    memset(&stats, 0, sizeof(stats));
+    memset(&lastStats, 0, sizeof(lastStats));
+}
+
+void WiFiPowerPolicy::begin(const WiFiPowerHooks &platform)
+{
+    if (started)
+    {
+        return;
+    }
+    hooks = platform;
+    lastAccountMs = statsStartMs = hooks.clockMs();
+    started = true;
+}
+
+void WiFiPowerPolicy::setAwake(WiFiWakeReason reason, uint32_t holdMs)
+{
+    if (!started)
+    {
+        return; // Not started: power save was never enabled
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    uint32_t until = hooks.clockMs() + holdMs;
+    if ((int32_t)(until - awakeUntil) > 0)
+    {
+        awakeUntil = until;
+    }
+    if (dozing)
+    {
+        hooks.setModemSleep(false);
+        dozing = false;
+        stats.wakes[reason]++;
+    }
+}
+
+void WiFiPowerPolicy::wake(WiFiWakeReason reason)
+{
+    setAwake(reason, reason == WIFI_WAKE_INPUT ? WIFI_POWER_INPUT_HOLD_MS : 0);
+}
+
+void WiFiPowerPolicy::beginActivity()
+{
+    activeRequests++;
+    setAwake(WIFI_WAKE_TRAFFIC, 0);
+}
+
+void WiFiPowerPolicy::endActivity()
+{
+    activeRequests--;
+    setAwake(WIFI_WAKE_TRAFFIC, WIFI_POWER_TAIL_MS);
+}
+
+void WiFiPowerPolicy::scheduleActivity(uint32_t atMs)
+{
+    nextActivityAt = atMs;
+    activityScheduled = true;
+}
+
+// Samples the mode once per loop pass: good enough for a current proxy
+void WiFiPowerPolicy::account(uint32_t now)
+{
+    uint32_t elapsed = now - lastAccountMs;
+    lastAccountMs = now;
+    if (dozing)
+    {
+        stats.dozeMs += elapsed;
+    }
+    else
+    {
+        stats.awakeMs += elapsed;
+    }
+
+    if (now - statsStartMs >= WIFI_POWER_STATS_INTERVAL_MS)
+    {
+        lastStats = stats;
+        if (hooks.logStats)
+        {
+            hooks.logStats(stats);
+        }
+        memset(&stats, 0, sizeof(stats));
+        statsStartMs = now;
+    }
+}
+
+void WiFiPowerPolicy::update(bool connected)
+{
+    if (!started)
+    {
+        return;
+    }
+    uint32_t now = hooks.clockMs();
+    account(now);
+
+    // Joining and DHCP go faster with the radio fully on
+    if (!connected)
+    {
+        activityScheduled = false;
+        wasConnected = false;
+        setAwake(WIFI_WAKE_TRAFFIC, 0);
+        return;
+    }
+
+    // WiFi.mode()/begin() reapply the library's default sleep mode: start each
+    // connection from a known state
+    if (!wasConnected)
+    {
+        wasConnected = true;
+        std::lock_guard<std::mutex> guard(lock);
+        hooks.setModemSleep(false);
+        dozing = false;
+        awakeUntil = now + WIFI_POWER_TAIL_MS;
+    }
+
+    // Leave doze just before the poll so its responses aren't held at the AP
+    if (activityScheduled && (int32_t)(nextActivityAt - now) <= WIFI_POWER_PREWAKE_MS)
+    {
+        activityScheduled = false;
+        setAwake(WIFI_WAKE_SCHEDULED, WIFI_POWER_PREWAKE_MS + WIFI_POWER_TAIL_MS);
+        return;
+    }
+
+    if (dozing || activeRequests.load() > 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!dozing && activeRequests.load() == 0 && (int32_t)(now - awakeUntil) >= 0)
+    {
+        hooks.setModemSleep(true);
+        dozing = true;
+    }
+}
+
+WiFiActivity::WiFiActivity()
+{
+    wifiPower.beginActivity();
+}
+
+WiFiActivity::~WiFiActivity()
+{
+    wifiPower.endActivity();
+}
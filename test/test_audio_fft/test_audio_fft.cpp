@@ -0,0 +1,180 @@
+// Host tests for the Q15 real FFT: accuracy against a double precision DFT,
+// bin placement, octave bands, and a scalar throughput benchmark.
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include "audio_fft.h"
+
+#define TEST_SAMPLE_RATE 16000
+#define TEST_BANDS 8
+
+static int16_t input[AUDIO_FFT_SIZE];
+static int32_t spectrum[AUDIO_FFT_BINS * 2];
+static uint32_t power[AUDIO_FFT_BINS];
+
+void setUp()
+{
+    audio_fft_init(TEST_SAMPLE_RATE, TEST_BANDS);
+}
+
+void tearDown()
+{
+}
+
+static void make_tone(double bin, double amplitude)
+{
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        input[n] = (int16_t)lround(amplitude * sin(2.0 * M_PI * bin * n / AUDIO_FFT_SIZE));
+    }
+}
+
+// Two tones plus a deterministic pseudo-random noise floor
+static void make_mix()
+{
+    uint32_t lfsr = 0xACE1u;
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        lfsr = lfsr * 1664525u + 1013904223u;
+        double noise = ((int32_t)(lfsr >> 16) - 32768) / 32768.0 * 600.0;
+        double v = 12000.0 * sin(2.0 * M_PI * 17.3 * n / AUDIO_FFT_SIZE) +
+                   6000.0 * sin(2.0 * M_PI * 61.8 * n / AUDIO_FFT_SIZE) + noise;
+        input[n] = (int16_t)v;
+    }
+}
+
+// SNR of audio_fft_real() against a double DFT of the same Hann-windowed input,
+// scaled like the fixed-point output (1/(N/2))
+static double snr_vs_reference_db()
+{
+    audio_fft_real(input, spectrum);
+
+    double signal = 0.0, noise = 0.0;
+    for (int k = 0; k < AUDIO_FFT_BINS; k++)
+    {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+        {
+            double w = 0.25 * (1.0 - cos(2.0 * M_PI * n / AUDIO_FFT_SIZE));
+            double phase = 2.0 * M_PI * k * n / AUDIO_FFT_SIZE;
+            re += input[n] * w * cos(phase);
+            im -= input[n] * w * sin(phase);
+        }
+        re /= AUDIO_FFT_SIZE / 2;
+        im /= AUDIO_FFT_SIZE / 2;
+
+        double er = spectrum[2 * k] - re;
+        double ei = spectrum[2 * k + 1] - im;
+        signal += re * re + im * im;
+        noise += er * er + ei * ei;
+    }
+    return 10.0 * log10(signal / (noise + 1e-9));
+}
+
+void test_fft_matches_double_dft()
+{
+    make_mix();
+    double snr = snr_vs_reference_db();
+
+    char message[64];
+    snprintf(message, sizeof(message), "scalar FFT SNR %.1f dB", snr);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN_FLOAT(45.0f, (float)snr);
+}
+
+void test_fft_full_scale_does_not_wrap()
+{
+    // Square wave: every butterfly sees its largest sums
+    for (int n = 0; n < AUDIO_FFT_SIZE; n++)
+    {
+        input[n] = (n / 8) & 1 ? -32768 : 32767;
+    }
+    TEST_ASSERT_GREATER_THAN_FLOAT(45.0f, (float)snr_vs_reference_db());
+}
+
+void test_fft_tone_lands_in_its_bin()
+{
+    make_tone(32.0, 16000.0);
+    audio_fft_power(input, power);
+
+    int peak = 0;
+    for (int k = 1; k < AUDIO_FFT_BINS; k++)
+    {
+        if (power[k] > power[peak])
+            peak = k;
+    }
+    TEST_ASSERT_EQUAL_INT(32, peak);
+
+    // Hann main lobe is three bins wide; everything else is far below
+    for (int k = 0; k < AUDIO_FFT_BINS; k++)
+    {
+        if (k < 31 || k > 33)
+        {
+            TEST_ASSERT_LESS_THAN_UINT32(power[peak] / 10000, power[k]);
+        }
+    }
+}
+
+void test_fft_dc_and_nyquist_are_real()
+{
+    make_mix();
+    audio_fft_real(input, spectrum);
+    TEST_ASSERT_EQUAL_INT(0, spectrum[1]);
+    TEST_ASSERT_EQUAL_INT(0, spectrum[2 * (AUDIO_FFT_BINS - 1) + 1]);
+}
+
+void test_bands_follow_octaves()
+{
+    // Centers are 1 kHz * 2^(b - 4): 62.5 Hz ... 8 kHz (Nyquist, probed at 7 kHz).
+    // The two lowest bands are one or two bins wide, too narrow for a clean tone.
+    static const double centersHz[TEST_BANDS] = {62.5, 125, 250, 500, 1000, 2000, 4000, 7000};
+    for (int b = 2; b < TEST_BANDS; b++)
+    {
+        make_tone(centersHz[b] * AUDIO_FFT_SIZE / TEST_SAMPLE_RATE, 16000.0);
+        audio_fft_power(input, power);
+
+        float bands[TEST_BANDS];
+        audio_fft_bands(power, bands, TEST_BANDS);
+
+        int loudest = 0;
+        for (int i = 1; i < TEST_BANDS; i++)
+        {
+            if (bands[i] > bands[loudest])
+                loudest = i;
+        }
+        TEST_ASSERT_EQUAL_INT(b, loudest);
+        TEST_ASSERT_FLOAT_WITHIN(0.25f, 1.0f, bands[b]);
+    }
+}
+
+void test_fft_benchmark()
+{
+    make_mix();
+    const int iterations = 20000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        audio_fft_power(input, power);
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%d-point real FFT + power: %.2f us/frame on host", AUDIO_FFT_SIZE,
+             us / iterations);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, power[17]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fft_matches_double_dft);
+    RUN_TEST(test_fft_full_scale_does_not_wrap);
+    RUN_TEST(test_fft_tone_lands_in_its_bin);
+    RUN_TEST(test_fft_dc_and_nyquist_are_real);
+    RUN_TEST(test_bands_follow_octaves);
+    RUN_TEST(test_fft_benchmark);
+    return UNITY_END();
+}
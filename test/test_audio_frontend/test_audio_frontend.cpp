@@ -0,0 +1,183 @@
+// Host tests for the Q15 microphone front end: saturation, DC removal, integer
+// levels, AGC behaviour, and the float-vs-Q15 benchmark.
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include "audio_frontend.h"
+
+#define BLOCK 256
+
+static int32_t raw[BLOCK];
+static int16_t out[BLOCK];
+static AudioFrontEnd fe;
+
+void setUp()
+{
+    audio_frontend_init(fe);
+}
+
+void tearDown()
+{
+}
+
+// INMP441 slot: 24-bit sample left-aligned in 32 bits
+static void make_raw_tone(float amplitude, float offset, float hz, int phase)
+{
+    for (int i = 0; i < BLOCK; i++)
+    {
+        float v = amplitude * sinf(2.0f * (float)M_PI * hz * (phase + i) / 16000.0f) + offset;
+        raw[i] = (int32_t)(v * 8388607.0f) * 256;
+    }
+}
+
+void test_convert_saturates_instead_of_wrapping()
+{
+    raw[0] = INT32_MAX;
+    raw[1] = INT32_MIN;
+    raw[2] = 1000 << FRONTEND_INPUT_SHIFT;
+    raw[3] = -(1000 << FRONTEND_INPUT_SHIFT);
+    raw[4] = 40000 << FRONTEND_INPUT_SHIFT; // Wrapped to negative by the old & 0xFFFF
+    audio_frontend_convert(raw, out, 5);
+
+    TEST_ASSERT_EQUAL_INT16(32767, out[0]);
+    TEST_ASSERT_EQUAL_INT16(-32768, out[1]);
+    TEST_ASSERT_EQUAL_INT16(1000, out[2]);
+    TEST_ASSERT_EQUAL_INT16(-1000, out[3]);
+    TEST_ASSERT_EQUAL_INT16(32767, out[4]);
+}
+
+void test_convert_handles_unaligned_tail()
+{
+    for (int i = 0; i < 7; i++)
+    {
+        raw[i] = (i * 100) << FRONTEND_INPUT_SHIFT;
+    }
+    audio_frontend_convert(raw, out, 7);
+    for (int i = 0; i < 7; i++)
+    {
+        TEST_ASSERT_EQUAL_INT16(i * 100, out[i]);
+    }
+}
+
+void test_measure_is_exact_on_a_square_wave()
+{
+    for (int i = 0; i < BLOCK; i++)
+    {
+        out[i] = (i & 1) ? -1200 : 1200;
+    }
+    uint16_t rms, peak;
+    audio_frontend_measure(out, BLOCK, &rms, &peak);
+    TEST_ASSERT_EQUAL_INT(1200, rms);
+    TEST_ASSERT_EQUAL_INT(1200, peak);
+}
+
+void test_dc_block_removes_offset()
+{
+    // Tone riding on a large DC offset; after settling the mean is ~0
+    uint16_t rms = 0, peak = 0;
+    int64_t sum = 0;
+    for (int block = 0; block < 64; block++)
+    {
+        make_raw_tone(0.01f, 0.02f, 440.0f, block * BLOCK);
+        audio_frontend_process(fe, raw, out, BLOCK, &rms, &peak);
+    }
+    for (int i = 0; i < BLOCK; i++)
+    {
+        sum += out[i];
+    }
+    TEST_ASSERT_INT_WITHIN(40, 0, sum / BLOCK);
+
+    // The tone itself passes: 0.01 of full scale is ~10486 peak after the shift
+    TEST_ASSERT_INT_WITHIN(150, 7415, rms);
+}
+
+void test_agc_brings_quiet_speech_to_target()
+{
+    fe.agcEnabled = true;
+    uint16_t rms = 0, peak = 0;
+    for (int block = 0; block < 400; block++)
+    {
+        make_raw_tone(0.0005f, 0.0f, 300.0f, block * BLOCK);
+        audio_frontend_process(fe, raw, out, BLOCK, &rms, &peak);
+    }
+    TEST_ASSERT_INT_WITHIN(FRONTEND_AGC_TARGET_RMS / 8, FRONTEND_AGC_TARGET_RMS, rms);
+}
+
+void test_agc_drops_gain_at_once_on_loud_input()
+{
+    fe.agcEnabled = true;
+    uint16_t rms = 0, peak = 0;
+    for (int block = 0; block < 400; block++)
+    {
+        make_raw_tone(0.0005f, 0.0f, 300.0f, block * BLOCK);
+        audio_frontend_process(fe, raw, out, BLOCK, &rms, &peak);
+    }
+    TEST_ASSERT_GREATER_THAN(4 << 8, fe.agcGainQ8);
+
+    // Already above target without gain: back to unity on the first loud block
+    make_raw_tone(0.01f, 0.0f, 300.0f, 400 * BLOCK);
+    audio_frontend_process(fe, raw, out, BLOCK, &rms, &peak);
+    TEST_ASSERT_EQUAL_INT(1 << 8, fe.agcGainQ8);
+}
+
+void test_agc_never_boosts_the_noise_floor()
+{
+    fe.agcEnabled = true;
+    uint16_t rms = 0, peak = 0;
+    for (int block = 0; block < 200; block++)
+    {
+        for (int i = 0; i < BLOCK; i++)
+        {
+            raw[i] = ((i * 7919 + block * 31) % 61 - 30) << FRONTEND_INPUT_SHIFT;
+        }
+        audio_frontend_process(fe, raw, out, BLOCK, &rms, &peak);
+    }
+    TEST_ASSERT_EQUAL_INT(1 << 8, fe.agcGainQ8);
+    TEST_ASSERT_LESS_THAN(FRONTEND_AGC_MIN_RMS, rms);
+}
+
+static int64_t host_clock_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void test_frontend_benchmark()
+{
+    // Repeat so the host clock resolution doesn't dominate
+    AudioFrontEndTimings best = {1e9f, 1e9f, 1e9f, 1e9f, 0.0f, 0, 0};
+    for (int run = 0; run < 20; run++)
+    {
+        AudioFrontEndTimings timings;
+        audio_frontend_benchmark(host_clock_us, timings);
+        best.floatUs = fminf(best.floatUs, timings.floatUs);
+        best.convertUs = fminf(best.convertUs, timings.convertUs);
+        best.chainUs = fminf(best.chainUs, timings.chainUs);
+        best.agcUs = fminf(best.agcUs, timings.agcUs);
+        best.rms = timings.rms;
+    }
+
+    // x86 vectorizes the float baseline: only the device numbers rank the paths
+    char message[160];
+    snprintf(message, sizeof(message),
+             "per %d-sample block on host: float %.2f us, Q15 convert+RMS/peak %.2f us, +DC %.2f us, +AGC %.2f us",
+             FRONTEND_BENCHMARK_SAMPLES, best.floatUs, best.convertUs, best.chainUs, best.agcUs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0, best.rms);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_convert_saturates_instead_of_wrapping);
+    RUN_TEST(test_convert_handles_unaligned_tail);
+    RUN_TEST(test_measure_is_exact_on_a_square_wave);
+    RUN_TEST(test_dc_block_removes_offset);
+    RUN_TEST(test_agc_brings_quiet_speech_to_target);
+    RUN_TEST(test_agc_drops_gain_at_once_on_loud_input);
+    RUN_TEST(test_agc_never_boosts_the_noise_floor);
+    RUN_TEST(test_frontend_benchmark);
+    return UNITY_END();
+}
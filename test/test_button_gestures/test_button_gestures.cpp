@@ -0,0 +1,309 @@
+// Host tests for the gesture engine on the firmware's own binding table:
+// press/release timelines per screen, in virtual time, with the screen
+// switches the actions would make.
+#include <unity.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "button_bindings.h"
+
+struct Fired
+{
+    std::string action;
+    uint16_t repeat;
+    uint32_t timeMs;
+};
+
+static GestureEngine engine;
+static uint8_t screen;
+static uint32_t nowMs;
+static std::vector<Fired> fired;
+static std::vector<std::string> logged;
+
+static void record(const char *action, const GestureEvent &event)
+{
+    fired.push_back({action, event.repeat, event.timeMs});
+}
+
+// Stand-ins for the actions in button.cpp; screen switches as on the device
+void gestureOpenDevices(const GestureEvent &event)
+{
+    record("devices", event);
+    screen = SCREEN_DEVICES;
+}
+
+void gestureOpenSpectrum(const GestureEvent &event)
+{
+    record("spectrum", event);
+    screen = SCREEN_SPECTRUM;
+}
+
+void gestureBackToMain(const GestureEvent &event)
+{
+    record("back", event);
+    screen = SCREEN_MAIN;
+}
+
+void gesturePlayPause(const GestureEvent &event) { record("play/pause", event); }
+void gestureNextTrack(const GestureEvent &event) { record("next", event); }
+void gesturePreviousTrack(const GestureEvent &event) { record("previous", event); }
+void gestureSelectDevice(const GestureEvent &event) { record("select", event); }
+void gestureDeviceDown(const GestureEvent &event) { record("down", event); }
+void gestureDeviceUp(const GestureEvent &event) { record("up", event); }
+void gestureVolumeUp(const GestureEvent &event) { record("volume up", event); }
+void gestureVolumeDown(const GestureEvent &event) { record("volume down", event); }
+void gestureToggleRecording(const GestureEvent &event) { record("record", event); }
+
+static uint8_t test_screen()
+{
+    return screen;
+}
+
+static uint32_t test_clock_ms()
+{
+    return nowMs;
+}
+
+static void test_logger(const char *name)
+{
+    logged.push_back(name);
+}
+
+static void start_on(UIScreen start)
+{
+    screen = start;
+    nowMs = 1000;
+    fired.clear();
+    logged.clear();
+    gesture_init(engine, gestureBindings, GESTURE_BINDING_COUNT, test_screen, test_clock_ms, test_logger);
+}
+
+// Advance virtual time in loop-sized steps, polling like handleSpotifyControls()
+static void run_until(uint32_t untilMs)
+{
+    while (nowMs < untilMs)
+    {
+        nowMs = std::min(nowMs + 10, untilMs);
+        gesture_poll(engine);
+    }
+}
+
+static void press(uint8_t button, uint32_t atMs)
+{
+    run_until(atMs);
+    gesture_input(engine, button, true, atMs);
+}
+
+static void release(uint8_t button, uint32_t atMs)
+{
+    run_until(atMs);
+    gesture_input(engine, button, false, atMs);
+}
+
+static void assert_fired(size_t index, const char *action, uint16_t repeat, uint32_t timeMs)
+{
+    TEST_ASSERT_TRUE_MESSAGE(index < fired.size(), action);
+    TEST_ASSERT_EQUAL_STRING(action, fired[index].action.c_str());
+    TEST_ASSERT_EQUAL_UINT32(repeat, fired[index].repeat);
+    TEST_ASSERT_EQUAL_UINT32(timeMs, fired[index].timeMs);
+}
+
+void setUp()
+{
+    start_on(SCREEN_MAIN);
+}
+
+void tearDown()
+{
+}
+
+void test_main_tap_play_fires_on_release()
+{
+    // A long press is also bound to button 1: the release decides
+    press(0, 1000);
+    run_until(1100);
+    TEST_ASSERT_EQUAL_INT(0, fired.size());
+    release(0, 1120);
+    run_until(2000);
+
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "play/pause", 0, 1120);
+    TEST_ASSERT_EQUAL_INT(1, logged.size());
+    TEST_ASSERT_EQUAL_STRING("play/pause", logged[0].c_str());
+}
+
+void test_main_long_press_opens_devices_while_held()
+{
+    press(0, 1000);
+    run_until(1000 + GESTURE_LONG_PRESS_MS + 50);
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "devices", 0, 1000 + GESTURE_LONG_PRESS_MS);
+    TEST_ASSERT_EQUAL_INT(SCREEN_DEVICES, screen);
+
+    // The release belongs to the spent press, not to "select" on the new screen
+    release(0, 1900);
+    run_until(2500);
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+}
+
+void test_main_tap_next_and_previous()
+{
+    press(1, 1000);
+    release(1, 1090);
+    press(2, 1400);
+    release(2, 1480);
+    run_until(2000);
+
+    TEST_ASSERT_EQUAL_INT(2, fired.size());
+    assert_fired(0, "next", 0, 1090);
+    assert_fired(1, "previous", 0, 1480);
+}
+
+void test_main_hold_repeats_volume()
+{
+    // Next is also bound to a tap: the repeat starts at the long press threshold
+    press(1, 1000);
+    run_until(1000 + GESTURE_LONG_PRESS_MS + 2 * GESTURE_REPEAT_INTERVAL_MS + 20);
+    release(1, nowMs);
+    run_until(nowMs + 500);
+
+    uint32_t startMs = 1000 + GESTURE_LONG_PRESS_MS;
+    TEST_ASSERT_EQUAL_INT(3, fired.size());
+    assert_fired(0, "volume up", 0, startMs);
+    assert_fired(1, "volume up", 1, startMs + GESTURE_REPEAT_INTERVAL_MS);
+    assert_fired(2, "volume up", 2, startMs + 2 * GESTURE_REPEAT_INTERVAL_MS);
+    TEST_ASSERT_EQUAL_INT(1, logged.size()); // Repeats are not logged
+}
+
+void test_main_chord_opens_spectrum()
+{
+    press(1, 1000);
+    press(2, 1000 + GESTURE_CHORD_WINDOW_MS - 20);
+    release(1, 1200);
+    release(2, 1210);
+    run_until(2000);
+
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "spectrum", 0, 1000 + GESTURE_CHORD_WINDOW_MS - 20);
+    TEST_ASSERT_EQUAL_INT(SCREEN_SPECTRUM, screen);
+}
+
+void test_main_chord_toggles_recording()
+{
+    press(2, 1000);
+    press(0, 1030);
+    release(0, 1150);
+    release(2, 1160);
+    run_until(2000);
+
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "record", 0, 1030);
+}
+
+void test_main_late_second_button_is_not_a_chord()
+{
+    press(1, 1000);
+    press(2, 1000 + GESTURE_CHORD_WINDOW_MS + 40);
+    release(1, 1200);
+    release(2, 1210);
+    run_until(2000);
+
+    TEST_ASSERT_EQUAL_INT(2, fired.size());
+    assert_fired(0, "next", 0, 1200);
+    assert_fired(1, "previous", 0, 1210);
+}
+
+void test_devices_tap_selects_and_hold_goes_back()
+{
+    start_on(SCREEN_DEVICES);
+    press(0, 1000);
+    release(0, 1100);
+    press(0, 1500);
+    run_until(1500 + GESTURE_LONG_PRESS_MS + 10);
+    release(0, 2300);
+    run_until(3000);
+
+    TEST_ASSERT_EQUAL_INT(2, fired.size());
+    assert_fired(0, "select", 0, 1100);
+    assert_fired(1, "back", 0, 1500 + GESTURE_LONG_PRESS_MS);
+    TEST_ASSERT_EQUAL_INT(SCREEN_MAIN, screen);
+}
+
+void test_devices_navigation_fires_on_press_and_repeats()
+{
+    start_on(SCREEN_DEVICES);
+
+    // Nothing else on these buttons: act on the press, repeat after the delay
+    press(1, 1000);
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "down", 0, 1000);
+    run_until(1000 + GESTURE_REPEAT_DELAY_MS + GESTURE_REPEAT_INTERVAL_MS + 10);
+    release(1, nowMs);
+
+    press(2, 2000);
+    release(2, 2050);
+    run_until(2500);
+
+    TEST_ASSERT_EQUAL_INT(4, fired.size());
+    assert_fired(1, "down", 1, 1000 + GESTURE_REPEAT_DELAY_MS);
+    assert_fired(2, "down", 2, 1000 + GESTURE_REPEAT_DELAY_MS + GESTURE_REPEAT_INTERVAL_MS);
+    assert_fired(3, "up", 0, 2000);
+}
+
+void test_spectrum_back_by_hold_or_chord()
+{
+    start_on(SCREEN_SPECTRUM);
+
+    // A tap on button 1 is not bound here
+    press(0, 1000);
+    release(0, 1100);
+    run_until(1500);
+    TEST_ASSERT_EQUAL_INT(0, fired.size());
+
+    press(0, 1500);
+    run_until(1500 + GESTURE_LONG_PRESS_MS + 10);
+    release(0, nowMs);
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "back", 0, 1500 + GESTURE_LONG_PRESS_MS);
+    TEST_ASSERT_EQUAL_INT(SCREEN_MAIN, screen);
+
+    start_on(SCREEN_SPECTRUM);
+    press(2, 1000);
+    press(1, 1040);
+    release(1, 1200);
+    release(2, 1200);
+    run_until(1500);
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "back", 0, 1040);
+}
+
+void test_queued_edges_resolve_in_edge_time()
+{
+    // A blocked loop delivers a whole press/release late: the tap still lands
+    // at the release time and no long press is invented
+    press(0, 1000);
+    nowMs = 3000;
+    gesture_input(engine, 0, false, 1150);
+    gesture_poll(engine);
+
+    TEST_ASSERT_EQUAL_INT(1, fired.size());
+    assert_fired(0, "play/pause", 0, 1150);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_main_tap_play_fires_on_release);
+    RUN_TEST(test_main_long_press_opens_devices_while_held);
+    RUN_TEST(test_main_tap_next_and_previous);
+    RUN_TEST(test_main_hold_repeats_volume);
+    RUN_TEST(test_main_chord_opens_spectrum);
+    RUN_TEST(test_main_chord_toggles_recording);
+    RUN_TEST(test_main_late_second_button_is_not_a_chord);
+    RUN_TEST(test_devices_tap_selects_and_hold_goes_back);
+    RUN_TEST(test_devices_navigation_fires_on_press_and_repeats);
+    RUN_TEST(test_spectrum_back_by_hold_or_chord);
+    RUN_TEST(test_queued_edges_resolve_in_edge_time);
+    return UNITY_END();
+}
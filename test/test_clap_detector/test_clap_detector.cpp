@@ -0,0 +1,451 @@
+// Clap detector harness: runs 16-bit mono 16 kHz WAV clips through the same
+// chain as the capture task (levels -> VAD -> onset_process_block) and reports,
+// per clip, onset and pattern detection latency and false positives.
+//
+// Clips: test/clips/*.wav (or $CLAP_CLIPS_DIR), recorded with
+// RECORD_FORMAT_PCM16 so they hold front end output. An optional sidecar
+// <clip>.txt lists the true clap times in seconds, one per line ('#' comments).
+// Clips without one are background/voice/music: everything detected in them is
+// a false positive. Synthetic clips cover the harness itself.
+#include <unity.h>
+#include <dirent.h>
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "audio_frontend.h"
+#include "audio_onset.h"
+#include "audio_vad.h"
+
+#define SAMPLE_RATE 16000
+#define BLOCK AUDIO_FFT_SIZE // One capture block is one FFT frame
+#define BLOCK_US (BLOCK * 1000000LL / SAMPLE_RATE)
+#define ONSET_MATCH_US (3 * BLOCK_US) // A detected onset this close after a true clap is a hit
+
+struct ClipReport
+{
+    float seconds;
+    int claps;          // Labeled
+    int onsetHits;
+    int falseOnsets;
+    int64_t onsetLatencySumUs; // Clap -> end of the block that detected it
+    int64_t onsetLatencyMaxUs;
+    int patternsExpected; // From grouping the labels like the recognizer does
+    int patternHits;
+    int falsePatterns;
+    int64_t patternLatencySumUs; // Last clap of the pattern -> decision
+    int64_t patternLatencyMaxUs;
+};
+
+struct ExpectedPattern
+{
+    ClapPattern kind;
+    int64_t lastClapUs;
+    bool matched;
+};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Minimal RIFF walk: 16-bit mono PCM at SAMPLE_RATE
+static bool read_wav(FILE *file, std::vector<int16_t> &samples)
+{
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool formatOk = false;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, file) == 8)
+    {
+        uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, file) != 16)
+                return false;
+            uint16_t formatTag = fmt[0] | (fmt[1] << 8);
+            uint16_t channels = fmt[2] | (fmt[3] << 8);
+            uint32_t rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24);
+            uint16_t bits = fmt[14] | (fmt[15] << 8);
+            formatOk = formatTag == 1 && channels == 1 && rate == SAMPLE_RATE && bits == 16;
+            fseek(file, size - 16 + (size & 1), SEEK_CUR);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            if (!formatOk)
+                return false;
+            samples.resize(size / 2);
+            samples.resize(fread(samples.data(), 2, samples.size(), file));
+            return true;
+        }
+        else
+        {
+            fseek(file, size + (size & 1), SEEK_CUR);
+        }
+    }
+    return false;
+}
+
+static void write_wav(FILE *file, const std::vector<int16_t> &samples)
+{
+    uint32_t dataBytes = samples.size() * 2;
+    uint32_t riffBytes = 36 + dataBytes;
+    uint32_t rate = SAMPLE_RATE, byteRate = SAMPLE_RATE * 2;
+    uint16_t format = 1, channels = 1, align = 2, bits = 16;
+    uint32_t fmtBytes = 16;
+
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riffBytes, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&fmtBytes, 4, 1, file);
+    fwrite(&format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&rate, 4, 1, file);
+    fwrite(&byteRate, 4, 1, file);
+    fwrite(&align, 2, 1, file);
+    fwrite(&bits, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&dataBytes, 4, 1, file);
+    fwrite(samples.data(), 2, samples.size(), file);
+}
+
+// Group labeled claps the way onset_update_pattern() does
+static std::vector<ExpectedPattern> expected_patterns(const std::vector<int64_t> &claps)
+{
+    std::vector<ExpectedPattern> patterns;
+    size_t i = 0;
+    while (i < claps.size())
+    {
+        size_t end = i + 1;
+        while (end < claps.size() && end - i < 3 && claps[end] - claps[end - 1] <= CLAP_MAX_GAP_MS * 1000LL)
+        {
+            end++;
+        }
+        if (end - i >= 2)
+        {
+            patterns.push_back({end - i == 3 ? CLAP_TRIPLE : CLAP_DOUBLE, claps[end - 1], false});
+        }
+        i = end;
+    }
+    return patterns;
+}
+
+static ClipReport run_clip(const std::vector<int16_t> &samples, const std::vector<int64_t> &claps)
+{
+    ClipReport report;
+    memset(&report, 0, sizeof(report));
+    report.claps = claps.size();
+    std::vector<bool> clapHit(claps.size(), false);
+    std::vector<ExpectedPattern> expected = expected_patterns(claps);
+    report.patternsExpected = expected.size();
+
+    OnsetDetector det;
+    onset_init(det);
+    AudioVad vad;
+    audio_vad_init(vad);
+    static uint32_t power[AUDIO_FFT_BINS];
+
+    int blocks = samples.size() / BLOCK;
+    // Run past the end so a pending double clap closes
+    int tailBlocks = CLAP_MAX_GAP_MS * 1000LL / BLOCK_US + 2;
+    static const int16_t silence[BLOCK] = {0};
+
+    for (int b = 0; b < blocks + tailBlocks; b++)
+    {
+        const int16_t *block = b < blocks ? &samples[b * BLOCK] : silence;
+        int64_t blockEndUs = (b + 1) * BLOCK_US; // Blocks are stamped when capture completes
+
+        uint16_t rms, peak;
+        bool vadOnset, onset;
+        audio_frontend_measure(block, BLOCK, &rms, &peak);
+        bool active = audio_vad_process(vad, block, BLOCK, rms, &vadOnset);
+        ClapPattern pattern = onset_process_block(det, block, active, blockEndUs, power, &onset);
+
+        if (onset)
+        {
+            // Earliest unmatched clap this block can have caught
+            bool hit = false;
+            for (size_t c = 0; c < claps.size() && !hit; c++)
+            {
+                int64_t latency = blockEndUs - claps[c];
+                if (!clapHit[c] && latency >= 0 && latency <= ONSET_MATCH_US)
+                {
+                    clapHit[c] = hit = true;
+                    report.onsetHits++;
+                    report.onsetLatencySumUs += latency;
+                    report.onsetLatencyMaxUs = std::max(report.onsetLatencyMaxUs, latency);
+                }
+            }
+            if (!hit)
+                report.falseOnsets++;
+        }
+
+        if (pattern != CLAP_NONE)
+        {
+            bool hit = false;
+            for (ExpectedPattern &want : expected)
+            {
+                int64_t latency = blockEndUs - want.lastClapUs;
+                if (!want.matched && want.kind == pattern && latency >= 0 &&
+                    latency <= CLAP_MAX_GAP_MS * 1000LL + ONSET_MATCH_US)
+                {
+                    want.matched = hit = true;
+                    report.patternHits++;
+                    report.patternLatencySumUs += latency;
+                    report.patternLatencyMaxUs = std::max(report.patternLatencyMaxUs, latency);
+                    break;
+                }
+            }
+            if (!hit)
+                report.falsePatterns++;
+        }
+    }
+
+    report.seconds = (float)samples.size() / SAMPLE_RATE;
+    return report;
+}
+
+static void print_report(const char *name, const ClipReport &r)
+{
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%s: %.1f s | onsets %d/%d hit, latency avg %lld max %lld ms, %d false | "
+             "patterns %d/%d hit, latency avg %lld max %lld ms, %d false (%.2f/min)",
+             name, r.seconds, r.onsetHits, r.claps,
+             r.onsetHits ? (long long)(r.onsetLatencySumUs / r.onsetHits / 1000) : 0LL,
+             (long long)(r.onsetLatencyMaxUs / 1000), r.falseOnsets, r.patternHits, r.patternsExpected,
+             r.patternHits ? (long long)(r.patternLatencySumUs / r.patternHits / 1000) : 0LL,
+             (long long)(r.patternLatencyMaxUs / 1000), r.falsePatterns,
+             r.seconds > 0 ? r.falsePatterns * 60.0f / r.seconds : 0.0f);
+    TEST_MESSAGE(line);
+}
+
+// --- Synthetic clips -------------------------------------------------------
+
+static uint32_t noiseState = 1;
+
+static float white()
+{
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return ((int32_t)(noiseState >> 8) - (1 << 23)) / (float)(1 << 23);
+}
+
+static void add_room_noise(std::vector<int16_t> &samples, float level)
+{
+    for (int16_t &s : samples)
+    {
+        s = (int16_t)(s + level * white());
+    }
+}
+
+// Broadband burst with a ~6 ms decay, like a clap close to the mic
+static void add_clap(std::vector<int16_t> &samples, double atSeconds, float level)
+{
+    size_t start = (size_t)(atSeconds * SAMPLE_RATE);
+    for (size_t i = 0; i < SAMPLE_RATE / 20 && start + i < samples.size(); i++)
+    {
+        float v = samples[start + i] + level * expf(-(float)i / (0.006f * SAMPLE_RATE)) * white();
+        samples[start + i] = (int16_t)fmaxf(fminf(v, 32767.0f), -32768.0f);
+    }
+}
+
+// Voiced syllables: 140 Hz harmonics up to 700 Hz with soft attacks
+static void add_speech(std::vector<int16_t> &samples, float level)
+{
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        double t = (double)i / SAMPLE_RATE;
+        double syllable = fmod(t, 0.3);
+        double envelope = syllable < 0.2 ? sin(M_PI * syllable / 0.2) : 0.0;
+        double pitch = 140.0 * (1.0 + 0.1 * sin(2.0 * M_PI * 0.7 * t));
+        double v = 0.0;
+        for (int h = 1; h <= 5; h++)
+        {
+            v += sin(2.0 * M_PI * pitch * h * t) / h;
+        }
+        samples[i] = (int16_t)(samples[i] + level * envelope * v);
+    }
+}
+
+static std::vector<int64_t> seconds_to_us(std::initializer_list<double> seconds)
+{
+    std::vector<int64_t> us;
+    for (double s : seconds)
+        us.push_back((int64_t)(s * 1000000.0));
+    return us;
+}
+
+void test_double_clap_is_detected()
+{
+    std::vector<int16_t> clip(4 * SAMPLE_RATE, 0);
+    add_room_noise(clip, 20.0f);
+    add_clap(clip, 1.0, 12000.0f);
+    add_clap(clip, 1.35, 12000.0f);
+
+    ClipReport r = run_clip(clip, seconds_to_us({1.0, 1.35}));
+    print_report("synthetic double", r);
+    TEST_ASSERT_EQUAL_INT(2, r.onsetHits);
+    TEST_ASSERT_EQUAL_INT(0, r.falseOnsets);
+    TEST_ASSERT_EQUAL_INT(1, r.patternHits);
+    TEST_ASSERT_EQUAL_INT(0, r.falsePatterns);
+    // A clap is decided at the end of its block; a double waits out CLAP_MAX_GAP_MS
+    TEST_ASSERT_LESS_OR_EQUAL(2 * BLOCK_US, r.onsetLatencyMaxUs);
+    TEST_ASSERT_LESS_OR_EQUAL(CLAP_MAX_GAP_MS * 1000LL + 2 * BLOCK_US, r.patternLatencyMaxUs);
+}
+
+void test_triple_clap_fires_on_the_third()
+{
+    std::vector<int16_t> clip(4 * SAMPLE_RATE, 0);
+    add_room_noise(clip, 20.0f);
+    add_clap(clip, 1.0, 10000.0f);
+    add_clap(clip, 1.3, 10000.0f);
+    add_clap(clip, 1.6, 10000.0f);
+
+    ClipReport r = run_clip(clip, seconds_to_us({1.0, 1.3, 1.6}));
+    print_report("synthetic triple", r);
+    TEST_ASSERT_EQUAL_INT(3, r.onsetHits);
+    TEST_ASSERT_EQUAL_INT(1, r.patternHits);
+    TEST_ASSERT_EQUAL_INT(0, r.falsePatterns);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * BLOCK_US, r.patternLatencyMaxUs);
+}
+
+void test_single_clap_is_not_a_pattern()
+{
+    std::vector<int16_t> clip(3 * SAMPLE_RATE, 0);
+    add_room_noise(clip, 20.0f);
+    add_clap(clip, 1.0, 12000.0f);
+
+    ClipReport r = run_clip(clip, seconds_to_us({1.0}));
+    TEST_ASSERT_EQUAL_INT(1, r.onsetHits);
+    TEST_ASSERT_EQUAL_INT(0, r.falsePatterns);
+}
+
+void test_speech_triggers_no_patterns()
+{
+    std::vector<int16_t> clip(10 * SAMPLE_RATE, 0);
+    add_room_noise(clip, 20.0f);
+    add_speech(clip, 6000.0f);
+
+    ClipReport r = run_clip(clip, {});
+    print_report("synthetic speech", r);
+    TEST_ASSERT_EQUAL_INT(0, r.falsePatterns);
+    TEST_ASSERT_EQUAL_INT(0, r.falseOnsets);
+}
+
+void test_wav_round_trip()
+{
+    std::vector<int16_t> clip(2 * SAMPLE_RATE, 0);
+    add_room_noise(clip, 20.0f);
+    add_clap(clip, 0.5, 12000.0f);
+    add_clap(clip, 0.8, 12000.0f);
+
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    write_wav(file, clip);
+    rewind(file);
+    std::vector<int16_t> read;
+    TEST_ASSERT_TRUE(read_wav(file, read));
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_INT(clip.size(), read.size());
+    TEST_ASSERT_TRUE(memcmp(clip.data(), read.data(), clip.size() * 2) == 0);
+    TEST_ASSERT_EQUAL_INT(1, run_clip(read, seconds_to_us({0.5, 0.8})).patternHits);
+}
+
+// --- Recorded clips --------------------------------------------------------
+
+static std::vector<int64_t> read_labels(const std::string &path)
+{
+    std::vector<int64_t> claps;
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file)
+        return claps;
+
+    char line[128];
+    while (fgets(line, sizeof(line), file))
+    {
+        char *end;
+        double seconds = strtod(line, &end);
+        if (end != line && line[0] != '#')
+            claps.push_back((int64_t)(seconds * 1000000.0));
+    }
+    fclose(file);
+    return claps;
+}
+
+void test_recorded_clips()
+{
+    const char *dir = getenv("CLAP_CLIPS_DIR") ? getenv("CLAP_CLIPS_DIR") : "test/clips";
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        TEST_IGNORE_MESSAGE("no recorded clips (test/clips or $CLAP_CLIPS_DIR)");
+    }
+
+    std::vector<std::string> names;
+    while (struct dirent *entry = readdir(d))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".wav") == 0 ||
+                                name.compare(name.size() - 4, 4, ".WAV") == 0))
+            names.push_back(name);
+    }
+    closedir(d);
+
+    ClipReport total;
+    memset(&total, 0, sizeof(total));
+    for (const std::string &name : names)
+    {
+        std::string path = std::string(dir) + "/" + name;
+        FILE *file = fopen(path.c_str(), "rb");
+        std::vector<int16_t> samples;
+        bool ok = file && read_wav(file, samples);
+        if (file)
+            fclose(file);
+        if (!ok)
+        {
+            TEST_MESSAGE((name + ": skipped, needs 16-bit mono PCM at 16 kHz").c_str());
+            continue;
+        }
+
+        ClipReport r = run_clip(samples, read_labels(path.substr(0, path.size() - 4) + ".txt"));
+        print_report(name.c_str(), r);
+        total.seconds += r.seconds;
+        total.claps += r.claps;
+        total.onsetHits += r.onsetHits;
+        total.falseOnsets += r.falseOnsets;
+        total.onsetLatencySumUs += r.onsetLatencySumUs;
+        total.onsetLatencyMaxUs = std::max(total.onsetLatencyMaxUs, r.onsetLatencyMaxUs);
+        total.patternsExpected += r.patternsExpected;
+        total.patternHits += r.patternHits;
+        total.falsePatterns += r.falsePatterns;
+        total.patternLatencySumUs += r.patternLatencySumUs;
+        total.patternLatencyMaxUs = std::max(total.patternLatencyMaxUs, r.patternLatencyMaxUs);
+    }
+    print_report("all clips", total);
+}
+
+int main()
+{
+    audio_fft_init(SAMPLE_RATE, 8);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_double_clap_is_detected);
+    RUN_TEST(test_triple_clap_fires_on_the_third);
+    RUN_TEST(test_single_clap_is_not_a_pattern);
+    RUN_TEST(test_speech_triggers_no_patterns);
+    RUN_TEST(test_wav_round_trip);
+    RUN_TEST(test_recorded_clips);
+    return UNITY_END();
+}
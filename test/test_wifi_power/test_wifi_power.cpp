@@ -0,0 +1,175 @@
+// Host tests for the modem sleep policy in virtual time: the main loop's poll
+// schedule, input and request holds, and the awake share it ends up with.
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "wifi_power.h"
+
+#define LOOP_MS 5       // One main loop pass
+#define POLL_MS 3000    // main.cpp polls every 3 s on the main screen
+#define REQUEST_MS 400  // A playback state request, blocking the loop like updateSpotifyData()
+
+static WiFiPowerPolicy *policy;
+static uint32_t nowMs;
+static bool radioDozing;
+static uint32_t modeSwitches;
+static WiFiPowerStats logged;
+static uint32_t logCount;
+
+static uint32_t test_clock_ms()
+{
+    return nowMs;
+}
+
+static void test_set_modem_sleep(bool doze)
+{
+    radioDozing = doze;
+    modeSwitches++;
+}
+
+static void test_log_stats(const WiFiPowerStats &stats)
+{
+    logged = stats;
+    logCount++;
+}
+
+void setUp()
+{
+    nowMs = 10000;
+    radioDozing = false;
+    modeSwitches = 0;
+    logCount = 0;
+    memset(&logged, 0, sizeof(logged));
+    policy = new WiFiPowerPolicy();
+    policy->begin({test_clock_ms, test_set_modem_sleep, test_log_stats});
+}
+
+void tearDown()
+{
+    delete policy;
+}
+
+static void loop_until(uint32_t untilMs, bool connected = true)
+{
+    while ((int32_t)(untilMs - nowMs) > 0)
+    {
+        nowMs += LOOP_MS;
+        policy->update(connected);
+    }
+}
+
+void test_not_started_leaves_the_radio_alone()
+{
+    WiFiPowerPolicy idle;
+    idle.update(true);
+    idle.wake(WIFI_WAKE_INPUT);
+    idle.beginActivity();
+    idle.endActivity();
+    TEST_ASSERT_FALSE(idle.isDozing());
+    TEST_ASSERT_EQUAL_UINT32(0, modeSwitches);
+}
+
+void test_stays_awake_while_disconnected()
+{
+    loop_until(nowMs + 5000, false);
+    TEST_ASSERT_FALSE(radioDozing);
+    TEST_ASSERT_FALSE(policy->isDozing());
+}
+
+void test_dozes_after_the_connect_tail()
+{
+    policy->update(true);
+    loop_until(nowMs + WIFI_POWER_TAIL_MS - 2 * LOOP_MS);
+    TEST_ASSERT_FALSE(radioDozing);
+    loop_until(nowMs + 3 * LOOP_MS);
+    TEST_ASSERT_TRUE(radioDozing);
+}
+
+void test_request_holds_the_radio_then_tails()
+{
+    loop_until(nowMs + 1000);
+    TEST_ASSERT_TRUE(radioDozing);
+
+    // A request from another task wakes it at once and holds it however long it takes
+    policy->beginActivity();
+    TEST_ASSERT_FALSE(radioDozing);
+    loop_until(nowMs + 5000);
+    TEST_ASSERT_FALSE(radioDozing);
+
+    policy->endActivity();
+    loop_until(nowMs + WIFI_POWER_TAIL_MS - LOOP_MS);
+    TEST_ASSERT_FALSE(radioDozing);
+    loop_until(nowMs + 2 * LOOP_MS);
+    TEST_ASSERT_TRUE(radioDozing);
+}
+
+void test_input_holds_the_radio_for_commands()
+{
+    loop_until(nowMs + 1000);
+    policy->wake(WIFI_WAKE_INPUT);
+    TEST_ASSERT_FALSE(radioDozing);
+    loop_until(nowMs + WIFI_POWER_INPUT_HOLD_MS - LOOP_MS);
+    TEST_ASSERT_FALSE(radioDozing);
+    loop_until(nowMs + 2 * LOOP_MS);
+    TEST_ASSERT_TRUE(radioDozing);
+}
+
+void test_poll_schedule_awake_share()
+{
+    // The main loop: schedule the next poll every pass, poll every 3 s,
+    // each poll blocks the loop for one request
+    uint32_t lastPoll = nowMs;
+    uint32_t polls = 0, pollsStartedDozing = 0;
+    uint32_t endMs = nowMs + 5 * WIFI_POWER_STATS_INTERVAL_MS + LOOP_MS;
+
+    while ((int32_t)(endMs - nowMs) > 0)
+    {
+        nowMs += LOOP_MS;
+        policy->scheduleActivity(lastPoll + POLL_MS);
+        policy->update(true);
+
+        if (nowMs - lastPoll > POLL_MS)
+        {
+            lastPoll = nowMs;
+            polls++;
+            if (radioDozing)
+                pollsStartedDozing++;
+
+            policy->beginActivity();
+            nowMs += REQUEST_MS;
+            policy->endActivity();
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(5, logCount);
+    uint32_t total = logged.awakeMs + logged.dozeMs;
+    float awakeShare = (float)logged.awakeMs / total;
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%u polls of %u ms every %u ms: awake %.1f%% of the last minute, %u scheduled wakes, %u polls started dozing",
+             (unsigned)polls, REQUEST_MS, POLL_MS, awakeShare * 100.0f, (unsigned)logged.wakes[WIFI_WAKE_SCHEDULED],
+             (unsigned)pollsStartedDozing);
+    TEST_MESSAGE(message);
+
+    // Every poll finds the radio already up, and the wakes are the scheduled ones
+    TEST_ASSERT_EQUAL_UINT32(0, pollsStartedDozing);
+    TEST_ASSERT_EQUAL_UINT32(0, logged.wakes[WIFI_WAKE_TRAFFIC]);
+    TEST_ASSERT_UINT32_WITHIN(1, WIFI_POWER_STATS_INTERVAL_MS / (POLL_MS + LOOP_MS), logged.wakes[WIFI_WAKE_SCHEDULED]);
+
+    // Awake per poll: prewake + request + tail, plus a loop pass of slack
+    float expected = (float)(WIFI_POWER_PREWAKE_MS + REQUEST_MS + WIFI_POWER_TAIL_MS) / (POLL_MS + LOOP_MS);
+    TEST_ASSERT_FLOAT_WITHIN(0.03f, expected, awakeShare);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_not_started_leaves_the_radio_alone);
+    RUN_TEST(test_stays_awake_while_disconnected);
+    RUN_TEST(test_dozes_after_the_connect_tail);
+    RUN_TEST(test_request_holds_the_radio_then_tails);
+    RUN_TEST(test_input_holds_the_radio_for_commands);
+    RUN_TEST(test_poll_schedule_awake_share);
+    return UNITY_END();
+}